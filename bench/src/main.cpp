@@ -0,0 +1,700 @@
+#include "Salamander.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <random>
+
+struct BenchOptions {
+    uint32_t    count        = 20000;
+    uint32_t    warmupFrames = 30;
+    uint32_t    frames       = 300;
+    uint32_t    loads        = 20;
+    uint32_t    seed         = 1234;
+    bool        headless     = true;
+    const char* output       = nullptr;
+};
+
+struct BenchResult {
+    std::string        name;
+    std::vector<float> milliseconds;
+
+    uint64_t drawCalls     = 0;
+    uint64_t bytesUploaded = 0;
+};
+
+struct BenchEntity {
+    glm::vec2 position;
+    glm::vec2 velocity;
+    glm::vec2 size;
+    glm::vec4 color;
+};
+
+struct BenchSprite {
+    glm::vec2 position;
+    glm::vec2 size;
+    float     rotation;
+    glm::vec4 color;
+    uint32_t  texture;
+};
+
+static constexpr int TEXTURE_COUNT = 8;
+
+static void WriteWav(const char* filename, uint32_t seed) {
+    constexpr uint32_t SAMPLE_RATE = 44100;
+    constexpr uint16_t CHANNELS    = 2;
+    constexpr uint32_t FRAMES      = SAMPLE_RATE * 2;
+    constexpr uint32_t DATA_SIZE   = FRAMES * CHANNELS * sizeof(int16_t);
+
+    FILE* file = std::fopen(filename, "wb");
+
+    if (!file) {
+        return;
+    }
+
+    auto write32 = [&](uint32_t value) { std::fwrite(&value, sizeof(value), 1, file); };
+    auto write16 = [&](uint16_t value) { std::fwrite(&value, sizeof(value), 1, file); };
+
+    std::fwrite("RIFF", 1, 4, file);
+    write32(36 + DATA_SIZE);
+    std::fwrite("WAVEfmt ", 1, 8, file);
+    write32(16);
+    write16(1);
+    write16(CHANNELS);
+    write32(SAMPLE_RATE);
+    write32(SAMPLE_RATE * CHANNELS * sizeof(int16_t));
+    write16(CHANNELS * sizeof(int16_t));
+    write16(16);
+    std::fwrite("data", 1, 4, file);
+    write32(DATA_SIZE);
+
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> noise(-8192, 8192);
+
+    for (uint32_t i = 0; i < FRAMES * CHANNELS; i++) {
+        write16((uint16_t)(int16_t)noise(rng));
+    }
+
+    std::fclose(file);
+}
+
+class Bench : public sal::App {
+public:
+    Bench(const sal::Settings& settings, const BenchOptions& options) : sal::App(settings), m_options(options) {}
+
+    void Init() {
+        sal::Window& window = sal::App::GetWindow();
+        m_camera = sal::Camera(0.0f, window.Width(), window.Height(), 0.0f);
+
+        m_scenarios = {
+            { "static_sprites",  &Bench::SetupSprites,     &Bench::RenderStaticSprites },
+            { "rotated_sprites", &Bench::SetupSprites,     &Bench::RenderRotatedSprites },
+            { "mixed_shapes",    &Bench::SetupSprites,     &Bench::RenderMixedShapes },
+            { "texture_switch",  &Bench::SetupSprites,     &Bench::RenderTextureSwitch },
+            { "lines",           &Bench::SetupSprites,     &Bench::RenderLines },
+            { "bulk_sprites",    &Bench::SetupBulkSprites, &Bench::RenderBulkSprites },
+            { "opaque_sprites",  &Bench::SetupSprites,     &Bench::RenderOpaqueSprites },
+            { "blend_modes",     &Bench::SetupSprites,     &Bench::RenderBlendModes },
+        };
+
+        // small solid textures, distinct so every switch is a real flush
+        for (int i = 0; i < TEXTURE_COUNT; i++) {
+            uint32_t pixels[4] = {};
+            std::fill(std::begin(pixels), std::end(pixels), 0xff000000 | (0x1f * (i + 1)) << (8 * (i % 3)));
+
+            sal::gpu::TextureDesc desc = {
+                .filter = sal::gpu::TextureFilter::NEAREST,
+                .wrap   = sal::gpu::TextureWrap::CLAMP,
+                .format = sal::gpu::PixelFormat::RGBA,
+                .width  = 2,
+                .height = 2,
+                .pixels = pixels,
+            };
+
+            m_textures[i] = sal::App::GetRenderer().RegisterTexture(sal::MakeRef<sal::Texture>(desc));
+        }
+
+        StartScenario(0);
+    }
+
+    void Shutdown() {
+        for (sal::TextureID texture : m_textures) {
+            sal::App::GetRenderer().ReleaseTexture(texture);
+        }
+
+        WriteResults();
+    }
+
+    void Update(float delta) {
+        // delta and renderer stats both describe the previous frame
+        RecordPreviousFrame(delta);
+
+        if (m_scenario >= m_scenarios.size()) {
+            RunLoadScenarios();
+            RunJobScaling();
+            RunBroadphase();
+            RunAudioMix();
+            sal::App::Quit();
+            return;
+        }
+
+        sal::gpu::clear(0.0f, 0.0f, 0.0f, 1.0f);
+
+        sal::Renderer2D& renderer = sal::App::GetRenderer();
+
+        renderer.Begin(m_camera);
+        (this->*m_scenarios[m_scenario].render)(m_frame);
+        renderer.End();
+
+        m_lastScenario = m_scenario;
+        m_lastFrame    = m_frame;
+
+        m_frame++;
+
+        if (m_frame >= m_options.warmupFrames + m_options.frames) {
+            StartScenario(m_scenario + 1);
+        }
+    }
+private:
+    struct Scenario {
+        const char* name;
+        void (Bench::*setup)();
+        void (Bench::*render)(uint32_t frame);
+    };
+
+    void StartScenario(size_t index) {
+        m_scenario = index;
+        m_frame    = 0;
+
+        if (m_scenario >= m_scenarios.size()) {
+            return;
+        }
+
+        // reseed per scenario so each one is reproducible on its own
+        m_rng.seed(m_options.seed + (uint32_t)index);
+
+        BenchResult& result = m_results.emplace_back();
+        result.name = m_scenarios[m_scenario].name;
+
+        (this->*m_scenarios[m_scenario].setup)();
+    }
+
+    void RecordPreviousFrame(float delta) {
+        if (m_lastScenario >= m_scenarios.size() || m_lastFrame < m_options.warmupFrames) {
+            return;
+        }
+
+        const sal::RendererStats& stats = sal::App::GetRenderer().Stats();
+        BenchResult& result = m_results[m_lastScenario];
+
+        result.milliseconds.push_back(delta * 1000.0f);
+        result.drawCalls     += stats.drawCalls;
+        result.bytesUploaded += stats.bytesUploaded;
+
+        m_lastScenario = m_scenarios.size();
+    }
+
+    void SetupSprites() {
+        sal::Window& window = sal::App::GetWindow();
+
+        std::uniform_real_distribution<float> x(0.0f, (float)window.Width());
+        std::uniform_real_distribution<float> y(0.0f, (float)window.Height());
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        std::uniform_int_distribution<uint32_t> texture(0, TEXTURE_COUNT - 1);
+
+        m_sprites.resize(m_options.count);
+
+        for (BenchSprite& sprite : m_sprites) {
+            sprite.position = { x(m_rng), y(m_rng) };
+            sprite.size     = glm::vec2(8.0f + 24.0f * unit(m_rng));
+            sprite.rotation = unit(m_rng) * 6.2831853f;
+            sprite.color    = { unit(m_rng), unit(m_rng), unit(m_rng), 1.0f };
+            sprite.texture  = texture(m_rng);
+        }
+    }
+
+    void SetupBulkSprites() {
+        SetupSprites();
+
+        m_bulkSprites.clear();
+
+        for (const BenchSprite& sprite : m_sprites) {
+            m_bulkSprites.push_back({ sprite.position, sprite.size, sprite.rotation, sprite.color });
+        }
+    }
+
+    void RenderStaticSprites(uint32_t frame) {
+        sal::Renderer2D& renderer = sal::App::GetRenderer();
+
+        for (const BenchSprite& sprite : m_sprites) {
+            renderer.DrawTexture(m_textures[0], sprite.position, sprite.size, 0.0f, sprite.color);
+        }
+    }
+
+    void RenderRotatedSprites(uint32_t frame) {
+        sal::Renderer2D& renderer = sal::App::GetRenderer();
+
+        for (const BenchSprite& sprite : m_sprites) {
+            renderer.DrawTexture(m_textures[0], sprite.position, sprite.size, sprite.rotation + frame * 0.01f, sprite.color);
+        }
+    }
+
+    void RenderMixedShapes(uint32_t frame) {
+        sal::Renderer2D& renderer = sal::App::GetRenderer();
+
+        for (size_t i = 0; i < m_sprites.size(); i++) {
+            const BenchSprite& sprite = m_sprites[i];
+
+            // runs of 64 keep some batching between mode switches
+            switch ((i / 64) % 3) {
+                case 0: renderer.DrawRect(sprite.position, sprite.size, sprite.rotation, sprite.color); break;
+                case 1: renderer.DrawCircle(sprite.position, sprite.size.x * 0.5f, sprite.color); break;
+                case 2: renderer.DrawLine(sprite.position, sprite.position + sprite.size, sprite.color); break;
+            }
+        }
+    }
+
+    void RenderTextureSwitch(uint32_t frame) {
+        sal::Renderer2D& renderer = sal::App::GetRenderer();
+
+        for (const BenchSprite& sprite : m_sprites) {
+            renderer.DrawTexture(m_textures[sprite.texture], sprite.position, sprite.size, 0.0f, sprite.color);
+        }
+    }
+
+    void RenderLines(uint32_t frame) {
+        sal::Renderer2D& renderer = sal::App::GetRenderer();
+
+        for (const BenchSprite& sprite : m_sprites) {
+            glm::vec2 direction = { std::cos(sprite.rotation), std::sin(sprite.rotation) };
+            renderer.DrawLine(sprite.position, sprite.position + direction * sprite.size.x, sprite.color);
+        }
+    }
+
+    void RenderBulkSprites(uint32_t frame) {
+        sal::App::GetRenderer().DrawSprites(m_textures[0], m_bulkSprites.data(), (uint32_t)m_bulkSprites.size());
+    }
+
+    void RenderOpaqueSprites(uint32_t frame) {
+        sal::Renderer2D& renderer = sal::App::GetRenderer();
+        renderer.SetBlendMode(sal::gpu::BlendMode::NONE);
+
+        for (const BenchSprite& sprite : m_sprites) {
+            renderer.DrawTexture(m_textures[0], sprite.position, sprite.size, 0.0f, sprite.color);
+        }
+    }
+
+    void RenderBlendModes(uint32_t frame) {
+        static constexpr sal::gpu::BlendMode MODES[] = {
+            sal::gpu::BlendMode::NONE,
+            sal::gpu::BlendMode::ALPHA,
+            sal::gpu::BlendMode::ADDITIVE,
+        };
+
+        sal::Renderer2D& renderer = sal::App::GetRenderer();
+
+        for (size_t i = 0; i < m_sprites.size(); i++) {
+            const BenchSprite& sprite = m_sprites[i];
+
+            // runs of 64 like mixed_shapes, opaque ones interleave with the rest
+            renderer.SetBlendMode(MODES[(i / 64) % 3]);
+            renderer.DrawTexture(m_textures[0], sprite.position, sprite.size, 0.0f, sprite.color);
+        }
+    }
+
+    void RunLoadScenarios() {
+        using Clock = std::chrono::steady_clock;
+
+        BenchResult& textureLoad = m_results.emplace_back();
+        textureLoad.name = "texture_load";
+
+        for (uint32_t i = 0; i < m_options.loads; i++) {
+            Clock::time_point start = Clock::now();
+            sal::Ref<sal::Texture> texture = LoadTexture(BENCH_ASSET_DIR "/raybunny.png");
+            textureLoad.milliseconds.push_back(std::chrono::duration<float, std::milli>(Clock::now() - start).count());
+        }
+
+        const char* wavFile = "salamander_bench.wav";
+        WriteWav(wavFile, m_options.seed);
+
+        BenchResult& soundLoad = m_results.emplace_back();
+        soundLoad.name = "sound_load";
+
+        for (uint32_t i = 0; i < m_options.loads; i++) {
+            Clock::time_point start = Clock::now();
+            sal::Ref<sal::Sound> sound = sal::Sound::Load(sal::App::GetAudio(), wavFile);
+            soundLoad.milliseconds.push_back(std::chrono::duration<float, std::milli>(Clock::now() - start).count());
+        }
+
+        BenchResult& soundLoadAdpcm = m_results.emplace_back();
+        soundLoadAdpcm.name = "sound_load_adpcm";
+
+        for (uint32_t i = 0; i < m_options.loads; i++) {
+            Clock::time_point start = Clock::now();
+            sal::Ref<sal::Sound> sound = sal::Sound::Load(sal::App::GetAudio(), wavFile, { .storage = sal::SoundStorage::ADPCM });
+            soundLoadAdpcm.milliseconds.push_back(std::chrono::duration<float, std::milli>(Clock::now() - start).count());
+        }
+
+        // a level's worth of sounds decoded side by side on the job system
+        BenchResult& soundLoadAsync = m_results.emplace_back();
+        soundLoadAsync.name = "sound_load_async_x8";
+
+        for (uint32_t i = 0; i < m_options.loads; i++) {
+            Clock::time_point start = Clock::now();
+            std::vector<sal::Ref<sal::SoundLoad>> loads;
+
+            for (int j = 0; j < 8; j++) {
+                loads.push_back(sal::Sound::LoadAsync(sal::App::GetAudio(), sal::App::GetJobs(), wavFile));
+            }
+
+            for (sal::Ref<sal::SoundLoad>& load : loads) {
+                load->Wait();
+            }
+
+            soundLoadAsync.milliseconds.push_back(std::chrono::duration<float, std::milli>(Clock::now() - start).count());
+        }
+
+        std::remove(wavFile);
+
+        RunShaderScenarios();
+    }
+
+    // the same program compiled from source, with a unique comment so the
+    // driver's own cache can not help, then loaded from the program cache
+    void RunShaderScenarios() {
+        using Clock = std::chrono::steady_clock;
+
+        static const char* VERTEX_SOURCE = "#version 100\n"
+        "attribute vec4 a_position;\n"
+        "varying vec2 v_textureCoord;\n"
+        "uniform mat4 u_projection;\n"
+        "void main() {\n"
+        "   v_textureCoord = a_position.xy * 0.5 + 0.5;\n"
+        "   gl_Position    = u_projection * a_position;\n"
+        "}";
+
+        static const char* FRAGMENT_SOURCE = "#version 100\n"
+        "precision mediump float;\n"
+        "varying vec2 v_textureCoord;\n"
+        "uniform sampler2D u_texture;\n"
+        "void main() {\n"
+        "   gl_FragColor = texture2D(u_texture, v_textureCoord);\n"
+        "}";
+
+        sal::gpu::VertexAttribute attribute = { .format = sal::gpu::VertexFormat::FLOAT4, .name = "a_position" };
+
+        sal::gpu::ShaderDesc desc = {
+            .vertexSource   = VERTEX_SOURCE,
+            .fragmentSource = FRAGMENT_SOURCE,
+            .layout         = { .count = 1, .size = sizeof(glm::vec4), .attributes = &attribute },
+        };
+
+        BenchResult& compile = m_results.emplace_back();
+        compile.name = "shader_compile";
+
+        for (uint32_t i = 0; i < m_options.loads; i++) {
+            std::string fragment = std::string(FRAGMENT_SOURCE) + "\n// " + std::to_string(m_options.seed) + " " + std::to_string(i) + "\n";
+
+            sal::gpu::ShaderDesc unique = desc;
+            unique.fragmentSource = fragment.c_str();
+
+            Clock::time_point start = Clock::now();
+            sal::gpu::ShaderHandle shader = sal::gpu::createShader(unique);
+            compile.milliseconds.push_back(std::chrono::duration<float, std::milli>(Clock::now() - start).count());
+
+            sal::gpu::destroyShader(shader);
+        }
+
+        if (!sal::gpu::programBinariesSupported()) {
+            return;
+        }
+
+        const char* cacheDirectory = "salamander_bench_shaders";
+        sal::gpu::setProgramCacheDirectory(cacheDirectory);
+
+        // the first one compiles and fills the cache
+        sal::gpu::destroyShader(sal::gpu::createShader(desc));
+
+        BenchResult& cached = m_results.emplace_back();
+        cached.name = "shader_cache_load";
+
+        for (uint32_t i = 0; i < m_options.loads; i++) {
+            Clock::time_point start = Clock::now();
+            sal::gpu::ShaderHandle shader = sal::gpu::createShader(desc);
+            cached.milliseconds.push_back(std::chrono::duration<float, std::milli>(Clock::now() - start).count());
+
+            sal::gpu::destroyShader(shader);
+        }
+
+        sal::gpu::setProgramCacheDirectory(nullptr);
+        std::filesystem::remove_all(cacheDirectory);
+    }
+
+    // the bunnymark entity update on 1, 2, 4, ... threads
+    void RunJobScaling() {
+        using Clock = std::chrono::steady_clock;
+
+        sal::Window& window = sal::App::GetWindow();
+        glm::vec2 bounds = { (float)window.Width(), (float)window.Height() };
+
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        m_rng.seed(m_options.seed);
+
+        std::vector<BenchEntity> entities(m_options.count * 10);
+
+        for (BenchEntity& entity : entities) {
+            float angle = unit(m_rng) * 6.2831853f;
+
+            entity.position = bounds * 0.5f;
+            entity.velocity = glm::vec2(std::cos(angle), std::sin(angle)) * 100.0f;
+            entity.size     = glm::vec2(32.0f);
+            entity.color    = { unit(m_rng), unit(m_rng), unit(m_rng), 1.0f };
+        }
+
+        uint32_t hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+
+        for (uint32_t threads = 1; threads <= hardwareThreads; threads *= 2) {
+            sal::JobSystem jobs;
+            jobs.Init((int)threads - 1);
+
+            BenchResult& result = m_results.emplace_back();
+            result.name = "entity_update_" + std::to_string(threads) + "t";
+
+            for (uint32_t frame = 0; frame < m_options.frames; frame++) {
+                Clock::time_point start = Clock::now();
+
+                jobs.ParallelFor((uint32_t)entities.size(), 4096, [&](uint32_t begin, uint32_t end) {
+                    for (uint32_t i = begin; i < end; i++) {
+                        UpdateEntity(entities[i], bounds, 1.0f / 60.0f);
+                    }
+                });
+
+                result.milliseconds.push_back(std::chrono::duration<float, std::milli>(Clock::now() - start).count());
+            }
+
+            jobs.Shutdown();
+        }
+    }
+
+    // rebuild the spatial hash and gather every overlapping pair each frame
+    void RunBroadphase() {
+        using Clock = std::chrono::steady_clock;
+
+        sal::Window& window = sal::App::GetWindow();
+        glm::vec2 bounds = { (float)window.Width(), (float)window.Height() };
+
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        m_rng.seed(m_options.seed);
+
+        std::vector<BenchEntity> entities(m_options.count);
+        std::vector<sal::AABB>   boxes(entities.size());
+
+        for (BenchEntity& entity : entities) {
+            float angle = unit(m_rng) * 6.2831853f;
+
+            entity.position = bounds * glm::vec2(unit(m_rng), unit(m_rng));
+            entity.velocity = glm::vec2(std::cos(angle), std::sin(angle)) * 100.0f;
+            entity.size     = glm::vec2(8.0f);
+        }
+
+        sal::SpatialHash hash;
+        hash.SetCellSize(16.0f);
+
+        std::vector<std::pair<uint32_t, uint32_t>> pairs;
+
+        BenchResult& result = m_results.emplace_back();
+        result.name = "broadphase";
+
+        for (uint32_t frame = 0; frame < m_options.frames; frame++) {
+            for (size_t i = 0; i < entities.size(); i++) {
+                UpdateEntity(entities[i], bounds, 1.0f / 60.0f);
+                boxes[i] = { .min = entities[i].position - entities[i].size * 0.5f, .max = entities[i].position + entities[i].size * 0.5f };
+            }
+
+            Clock::time_point start = Clock::now();
+
+            pairs.clear();
+            hash.Build(sal::App::GetJobs(), boxes.data(), (uint32_t)boxes.size());
+            hash.QueryPairs(pairs);
+
+            result.milliseconds.push_back(std::chrono::duration<float, std::milli>(Clock::now() - start).count());
+        }
+    }
+
+    // 256 looping voices through a bus with the low pass and compressor on,
+    // mixed on this thread with the output device paused. the spatial run
+    // scatters them around the listener so most end up virtual
+    void RunAudioMix() {
+        using Clock = std::chrono::steady_clock;
+        constexpr uint32_t VOICES = 256;
+        constexpr uint32_t FRAMES = 1024;
+
+        sal::AudioDevice& audio = sal::App::GetAudio();
+
+        const char* wavFile = "salamander_bench.wav";
+        WriteWav(wavFile, m_options.seed);
+
+        sal::Ref<sal::Sound> sound = sal::Sound::Load(audio, wavFile);
+        std::remove(wavFile);
+
+        if (!sound) {
+            return;
+        }
+
+        audio.StopOutput();
+        audio.SetListener(glm::vec2(0.0f));
+        audio.SetNewVoicesPerFrame(VOICES);
+
+        std::vector<float> output(FRAMES * audio.Channels());
+        float blockSeconds = (float)FRAMES / (float)audio.SampleRate();
+
+        for (bool spatial : { false, true }) {
+            sal::MixerBus* bus = audio.CreateBus();
+
+            if (!bus) {
+                break;
+            }
+
+            bus->SetLowPass(2000.0f);
+            bus->SetCompressor({});
+
+            std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+            m_rng.seed(m_options.seed);
+
+            audio.NewFrame(0.0f);
+
+            for (uint32_t i = 0; i < VOICES; i++) {
+                sound->Play({
+                    .volume   = 0.1f,
+                    .pan      = unit(m_rng) * 2.0f - 1.0f,
+                    .pitch    = 0.5f + unit(m_rng),
+                    .looping  = true,
+                    .bus      = bus,
+                    .spatial  = spatial,
+                    .position = (glm::vec2(unit(m_rng), unit(m_rng)) * 2.0f - 1.0f) * 8192.0f,
+                });
+            }
+
+            BenchResult& result = m_results.emplace_back();
+            result.name = spatial ? "audio_mix_256_spatial" : "audio_mix_256_voices";
+
+            for (uint32_t frame = 0; frame < m_options.frames; frame++) {
+                Clock::time_point start = Clock::now();
+                audio.NewFrame(blockSeconds);
+                audio.Mix(output.data(), FRAMES);
+                result.milliseconds.push_back(std::chrono::duration<float, std::milli>(Clock::now() - start).count());
+            }
+
+            audio.DestroyBus(bus);
+        }
+
+        audio.SetNewVoicesPerFrame(sal::AudioDevice::DEFAULT_NEW_VOICES_PER_FRAME);
+        audio.StartOutput();
+    }
+
+    static void UpdateEntity(BenchEntity& entity, glm::vec2 bounds, float delta) {
+        entity.position += entity.velocity * delta;
+
+        glm::vec2 min = entity.position - entity.size * 0.5f;
+        glm::vec2 max = entity.position + entity.size * 0.5f;
+
+        for (int axis = 0; axis < 2; axis++) {
+            if (min[axis] < 0.0f) {
+                entity.velocity[axis] *= -1.0f;
+                entity.position[axis] = entity.size[axis] * 0.5f;
+            }
+            else if (max[axis] > bounds[axis]) {
+                entity.velocity[axis] *= -1.0f;
+                entity.position[axis] = bounds[axis] - entity.size[axis] * 0.5f;
+            }
+        }
+    }
+
+    void WriteResults() {
+        FILE* file = m_options.output ? std::fopen(m_options.output, "w") : stdout;
+
+        if (!file) {
+            std::printf("could not open %s\n", m_options.output);
+            return;
+        }
+
+        std::fprintf(file, "{\n  \"seed\": %u,\n  \"count\": %u,\n  \"frames\": %u,\n  \"scenarios\": [\n", m_options.seed, m_options.count, m_options.frames);
+
+        for (size_t i = 0; i < m_results.size(); i++) {
+            BenchResult&       result  = m_results[i];
+            sal::SampleSummary summary = sal::Summarize(result.milliseconds);
+
+            double count = summary.count == 0 ? 1.0 : (double)summary.count;
+
+            std::fprintf(file, "    { \"name\": \"%s\", \"samples\": %zu, \"avg_ms\": %.4f, \"min_ms\": %.4f, \"p50_ms\": %.4f, \"p90_ms\": %.4f, \"p99_ms\": %.4f, \"max_ms\": %.4f, \"draw_calls\": %.1f, \"bytes_uploaded\": %.0f }%s\n",
+                result.name.c_str(), summary.count, summary.average,
+                summary.min, summary.p50, summary.p90, summary.p99, summary.max,
+                result.drawCalls / count, result.bytesUploaded / count,
+                i + 1 < m_results.size() ? "," : "");
+        }
+
+        std::fprintf(file, "  ]\n}\n");
+
+        if (file != stdout) {
+            std::fclose(file);
+        }
+    }
+private:
+    BenchOptions m_options = {};
+
+    sal::Camera                               m_camera   = {};
+    std::array<sal::TextureID, TEXTURE_COUNT> m_textures = {};
+
+    std::vector<Scenario>    m_scenarios   = {};
+    std::vector<BenchResult> m_results     = {};
+    std::vector<BenchSprite> m_sprites     = {};
+    std::vector<sal::Sprite> m_bulkSprites = {};
+    std::mt19937             m_rng;
+
+    size_t   m_scenario     = 0;
+    uint32_t m_frame        = 0;
+    size_t   m_lastScenario = SIZE_MAX;
+    uint32_t m_lastFrame    = 0;
+};
+
+int main(int argc, char** argv) {
+    BenchOptions options = {};
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg   = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+        if (std::strcmp(arg, "--window") == 0) {
+            options.headless = false;
+        }
+        else if (value && std::strcmp(arg, "--count") == 0) {
+            options.count = (uint32_t)std::atoi(value); i++;
+        }
+        else if (value && std::strcmp(arg, "--frames") == 0) {
+            options.frames = (uint32_t)std::atoi(value); i++;
+        }
+        else if (value && std::strcmp(arg, "--loads") == 0) {
+            options.loads = (uint32_t)std::atoi(value); i++;
+        }
+        else if (value && std::strcmp(arg, "--seed") == 0) {
+            options.seed = (uint32_t)std::atoi(value); i++;
+        }
+        else if (value && std::strcmp(arg, "--out") == 0) {
+            options.output = value; i++;
+        }
+    }
+
+    sal::Settings settings = {
+        .windowWidth  = 1280,
+        .windowHeight = 720,
+        .windowTitle  = "salamander_bench",
+        .headless     = options.headless,
+
+        // keep the sound card out of the audio numbers, windowed or not
+        .audio = { .nullBackend = true },
+    };
+
+    Bench(settings, options).Run();
+}
@@ -1,5 +1,7 @@
 #include "Salamander.h"
 
+#include <cctype>
+
 struct Entity {
     glm::vec2 position;
     glm::vec2 velocity;
@@ -9,14 +11,17 @@ struct Entity {
 
 class BunnyMark : public sal::App {
 public:
+    BunnyMark(const sal::Settings& settings) : sal::App(settings) {}
+
     void Init() {
         sal::Window& window = sal::App::GetWindow();
         m_camera = sal::Camera(0.0f, window.Width(), window.Height(), 0.0f);
 
-        m_texture = LoadTexture("raybunny.png");
+        m_texture = sal::App::GetRenderer().RegisterTexture(LoadTexture("raybunny.png"));
     }
 
     void Shutdown() {
+        sal::App::GetRenderer().ReleaseTexture(m_texture);
     }
 
     void Update(float delta) {
@@ -103,9 +108,9 @@ private:
         renderer.End();
     }
 private:
-    sal::Camera            m_camera  = {};
-    sal::Ref<sal::Texture> m_texture = {};
-    std::vector<Entity>    m_entities;
+    sal::Camera         m_camera   = {};
+    sal::TextureID      m_texture  = {};
+    std::vector<Entity> m_entities;
 
     float deltaAverage  = 0.0f;
     float deltaAccum    = 0.0f;
@@ -113,6 +118,27 @@ private:
     int   frameCount    = 0;
 };
 
-int main() {
-    BunnyMark().Run();
+int main(int argc, char** argv) {
+    sal::Settings settings = {};
+
+    // --headless [frames] runs offscreen for a fixed number of frames,
+    // --record <file> and --replay <file> capture and play back a session
+    for (int i = 1; i < argc; i++) {
+        if (std::string(argv[i]) == "--headless") {
+            settings.headless   = true;
+            settings.frameLimit = 1000;
+
+            if (i + 1 < argc && std::isdigit((unsigned char)argv[i + 1][0])) {
+                settings.frameLimit = (uint32_t)std::atoi(argv[++i]);
+            }
+        }
+        else if (std::string(argv[i]) == "--record" && i + 1 < argc) {
+            settings.recordInput = argv[++i];
+        }
+        else if (std::string(argv[i]) == "--replay" && i + 1 < argc) {
+            settings.replayInput = argv[++i];
+        }
+    }
+
+    BunnyMark(settings).Run();
 }
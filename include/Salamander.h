@@ -1,12 +1,23 @@
 #pragma once
 
 #include "audio/AudioDevice.h"
+#include "audio/MixerBus.h"
+#include "audio/Music.h"
 #include "audio/Sound.h"
 
 #include "core/App.h"
+#include "core/FrameHistory.h"
 #include "core/Input.h"
+#include "core/InputRecorder.h"
+#include "core/JobSystem.h"
+#include "core/Profiler.h"
+#include "core/SpatialHash.h"
 #include "core/Window.h"
 
+#include "ecs/Components.h"
+#include "ecs/SpriteSystem.h"
+#include "ecs/World.h"
+
 #include "graphics/Camera.h"
 #include "graphics/gpu.h"
 #include "graphics/Renderer2D.h"
\ No newline at end of file
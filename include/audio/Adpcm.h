@@ -0,0 +1,53 @@
+#pragma once
+
+#include "core/Base.h"
+
+#include <miniaudio.h>
+
+namespace sal
+{
+    //NOTE: IMA ADPCM in blocks of ADPCM_BLOCK_FRAMES frames. every block
+    //      starts with a 4 byte header per channel holding the first
+    //      sample and step index, followed by 4 bit codes interleaved by
+    //      channel. blocks decode independently so seeking is cheap
+    static constexpr uint32_t ADPCM_BLOCK_FRAMES = 1024;
+    static constexpr uint32_t ADPCM_MAX_CHANNELS = 8;
+
+    size_t AdpcmBlockSize(uint32_t channels);
+    size_t AdpcmSize(uint64_t frameCount, uint32_t channels);
+
+    void AdpcmEncode(const int16_t* pcm, uint64_t frameCount, uint32_t channels, uint8_t* output);
+
+    //NOTE: ma_data_source that decodes to s16 while it is read, one per
+    //      voice so every voice keeps its own cursor
+    class AdpcmSource
+    {
+    public:
+        ma_result Init(const void* data, uint64_t frameCount, uint32_t channels, uint32_t sampleRate);
+        void Uninit();
+    private:
+        static ma_data_source_vtable s_vtable;
+
+        static ma_result OnRead(ma_data_source* source, void* output, ma_uint64 frameCount, ma_uint64* framesRead);
+        static ma_result OnSeek(ma_data_source* source, ma_uint64 frame);
+        static ma_result OnGetDataFormat(ma_data_source* source, ma_format* format, ma_uint32* channels, ma_uint32* sampleRate, ma_channel* channelMap, size_t channelMapCap);
+        static ma_result OnGetCursor(ma_data_source* source, ma_uint64* cursor);
+        static ma_result OnGetLength(ma_data_source* source, ma_uint64* length);
+
+        // decodes the frame at the cursor and advances, output may be null
+        void DecodeFrame(int16_t* output);
+    private:
+        // has to stay the first member, miniaudio casts to it
+        ma_data_source_base m_base = {};
+
+        const uint8_t* m_data       = nullptr;
+        uint64_t       m_frameCount = 0;
+        uint32_t       m_channels   = 0;
+        uint32_t       m_sampleRate = 0;
+        size_t         m_blockSize  = 0;
+
+        uint64_t                                m_cursor    = 0;
+        std::array<int32_t, ADPCM_MAX_CHANNELS> m_predictor = {};
+        std::array<int32_t, ADPCM_MAX_CHANNELS> m_index     = {};
+    };
+}
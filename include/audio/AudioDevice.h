@@ -1,21 +1,298 @@
 #pragma once
 
+#include "audio/Adpcm.h"
+#include "audio/MixerBus.h"
+#include "audio/PcmAllocator.h"
 #include "core/Base.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 #include <miniaudio.h>
 
 namespace sal
 {
+    class Camera;
+    class Music;
+    class Sound;
+
+    //NOTE: generation 0 is never handed out, a default handle is invalid.
+    //      handles go stale once their voice is stolen or reused
+    struct VoiceHandle
+    {
+        uint32_t index      = 0;
+        uint32_t generation = 0;
+
+        bool operator==(const VoiceHandle& other) const = default;
+    };
+
+    enum class AttenuationCurve
+    {
+        NONE,
+        LINEAR,      // 1 at minDistance down to 0 at maxDistance
+        INVERSE,     // minDistance / (minDistance + rolloff * (distance - minDistance))
+        EXPONENTIAL, // (distance / minDistance) ^ -rolloff
+    };
+
+    //NOTE: in world units. past maxDistance a voice is always virtual, no
+    //      matter the curve
+    struct Attenuation
+    {
+        AttenuationCurve curve       = AttenuationCurve::INVERSE;
+        float            minDistance = 64.0f;
+        float            maxDistance = 2048.0f;
+        float            rolloff     = 1.0f;
+    };
+
+    struct PlayParams
+    {
+        float volume   = 1.0f;
+        float pan      = 0.0f;
+        float pitch    = 1.0f;
+        bool  looping  = false;
+
+        // when the pool is full only voices of lower or equal priority are stolen
+        int   priority = 0;
+
+        // null plays straight into the master output
+        MixerBus* bus = nullptr;
+
+        // positioned relative to the listener, volume and pan are then
+        // scaled and offset by distance
+        bool        spatial     = false;
+        glm::vec2   position    = {};
+        Attenuation attenuation = {};
+    };
+
+    enum class AudioLatency
+    {
+        LOW,          // small periods, for input tied to the music
+        CONSERVATIVE, // large periods, fewer wake ups on battery powered devices
+    };
+
+    //NOTE: zeros leave the choice to the backend. an explicit period size
+    //      wins over latency, which only sets the default the backend uses
+    struct AudioSettings
+    {
+        // tried in order, empty uses miniaudio's default order
+        std::vector<ma_backend> backends = {};
+
+        // skips the sound card and consumes audio at the real rate, for
+        // headless runs and CI
+        bool nullBackend = false;
+
+        uint32_t sampleRate         = 0;
+        uint32_t channels           = 2;
+        uint32_t periodSizeInFrames = 0;
+        uint32_t periods            = 0;
+
+        AudioLatency latency = AudioLatency::LOW;
+    };
+
+    //NOTE: filled in by the audio thread. load is mix time over the
+    //      duration of the buffer being mixed, past 1 the device starves
+    struct AudioStats
+    {
+        uint64_t callbacks     = 0;
+        uint32_t slowMixes     = 0; // mixes that took longer than their buffer lasts, underruns are inferred from these
+        uint32_t lateCallbacks = 0; // callbacks more than LATE_PERIODS after the last one
+
+        // music that ran out of decoded data, every stream since Init
+        uint32_t streamUnderruns = 0;
+
+        float lastMixMs    = 0.0f;
+        float averageMixMs = 0.0f;
+        float peakMixMs    = 0.0f;
+        float load         = 0.0f;
+        float peakLoad     = 0.0f;
+
+        uint32_t activeVoices  = 0;
+        uint32_t virtualVoices = 0;
+        uint32_t peakVoices    = 0;
+
+        uint32_t periodFrames = 0;
+        uint32_t sampleRate   = 0;
+    };
+
     class AudioDevice
     {
     public:
-        void Init();
+        //NOTE: how often the streaming thread tops up music ring buffers
+        //      when nobody wakes it earlier
+        static constexpr uint32_t STREAM_INTERVAL_MS = 10;
+
+        //NOTE: a gap this many periods long between two callbacks counts as
+        //      late, the backend most likely played silence in between
+        static constexpr uint32_t LATE_PERIODS = 2;
+
+        static constexpr uint32_t MAX_VOICES                   = 256;
+        static constexpr uint32_t DEFAULT_NEW_VOICES_PER_FRAME = 16;
+
+        //NOTE: spatial voices quieter than this stop mixing and only keep
+        //      their cursor moving until they become audible again (-60 dB)
+        static constexpr float AUDIBLE_GAIN = 0.001f;
+
+        //NOTE: horizontal distance from the listener at which a spatial
+        //      voice is panned fully to one side
+        static constexpr float DEFAULT_PAN_DISTANCE = 512.0f;
+
+        void Init(const AudioSettings& settings = {});
         void Shutdown();
+
+        //NOTE: called by App once per frame, resets the new voice budget,
+        //      updates spatial voices and samples the voice count for the
+        //      stats. delta moves the cursors of virtual voices
+        void NewFrame(float delta);
+
+        //NOTE: the camera version listens from the center of its view
+        void SetListener(glm::vec2 position) { m_listener = position; }
+        void SetListener(const Camera& camera);
+        glm::vec2 Listener() const { return m_listener; }
+
+        void SetPanDistance(float distance) { m_panDistance = distance; }
+
+        //NOTE: plays beyond the budget are dropped so a burst of the same
+        //      effect in one frame cannot flush every other voice
+        void SetNewVoicesPerFrame(uint32_t count) { m_newVoicesPerFrame = count; }
+
+        VoiceHandle Play(Sound& sound, const PlayParams& params = {});
+
+        void Stop(VoiceHandle voice);
+        bool Playing(VoiceHandle voice) const;
+
+        void SetVolume(VoiceHandle voice, float volume);
+        void SetPan(VoiceHandle voice, float pan);
+        void SetPitch(VoiceHandle voice, float pitch);
+        void SetPosition(VoiceHandle voice, glm::vec2 position);
+
+        //NOTE: voices the mixer is working on, virtual ones are not included
+        uint32_t ActiveVoices() const;
+        uint32_t VirtualVoices() const;
+
+        //NOTE: buses live until DestroyBus or Shutdown. destroying a bus
+        //      stops its voices and moves its children to the master output
+        MixerBus* CreateBus(MixerBus* parent = nullptr);
+        void DestroyBus(MixerBus* bus);
+
+        //NOTE: while the output is stopped Mix renders the graph into output
+        //      on the calling thread. used for offline rendering and benchmarks
+        void StartOutput();
+        void StopOutput();
+        void Mix(float* output, uint32_t frameCount);
+
+        uint32_t Channels() const { return ma_engine_get_channels(&m_engine); }
+
+        AudioStats GetStats() const;
+
+        //NOTE: peaks start over from the next callback, counters keep going
+        void ResetPeaks();
+
+        uint32_t SampleRate() const { return ma_engine_get_sample_rate(&m_engine); }
+
+        //NOTE: backing memory for decoded sounds
+        PcmAllocator& GetPcmAllocator() { return m_pcm; }
     private:
         friend class Sound;
-        //friend class Music;
+        friend class Music;
+        friend class MixerBus;
+
+        struct Voice
+        {
+            // adpcm sounds are read through their own decoder instead of a plain buffer
+            ma_audio_buffer_ref buffer      = {};
+            AdpcmSource         adpcm       = {};
+            ma_data_source*     source      = nullptr;
+            ma_sound            sound       = {};
+            bool                initialized = false;
+
+            const Sound* owner      = nullptr;
+            MixerBus*    bus        = nullptr;
+            int          priority   = 0;
+            uint64_t     started    = 0;
+            uint32_t     generation = 1;
+
+            // what the game asked for, spatial gain and pan are applied on top
+            float volume  = 1.0f;
+            float pan     = 0.0f;
+            float pitch   = 1.0f;
+            bool  looping = false;
+
+            bool        spatial     = false;
+            glm::vec2   position    = {};
+            Attenuation attenuation = {};
+
+            // virtual voices are stopped in miniaudio, cursor is in frames
+            // of the sound and keeps advancing as if they still played
+            bool   virtualized = false;
+            double cursor      = 0.0;
+        };
+
+        Voice* GetVoice(VoiceHandle handle);
+        const Voice* GetVoice(VoiceHandle handle) const;
+
+        Voice* AcquireVoice(int priority);
+        void ReleaseVoice(Voice& voice);
+        void ReleaseSource(Voice& voice);
+        void StopVoices(const Sound& sound);
+
+        bool InUse(const Voice& voice) const;
+        void Spatialize(Voice& voice);
+        void AdvanceVirtual(Voice& voice, float delta);
+
+        static void DataCallback(ma_device* device, void* output, const void* input, ma_uint32 frameCount);
+
+        // mixes and records timing, shared by the device callback and Mix
+        void Render(float* output, uint32_t frameCount);
+
+        void AddStream(Music* music);
+        void RemoveStream(Music* music);
+        void WakeStreams();
+        void StreamLoop();
+    private:
+        ma_context   m_context = {};
+        ma_device    m_device  = {};
+        ma_engine    m_engine  = {};
+        PcmAllocator m_pcm     = {};
+
+        // written by the audio thread, see AudioStats
+        std::atomic<uint64_t> m_callbacks       = 0;
+        std::atomic<uint32_t> m_slowMixes       = 0;
+        std::atomic<uint32_t> m_lateCallbacks   = 0;
+        std::atomic<float>    m_lastMixMs       = 0.0f;
+        std::atomic<float>    m_averageMixMs    = 0.0f;
+        std::atomic<float>    m_peakMixMs       = 0.0f;
+        std::atomic<float>    m_load            = 0.0f;
+        std::atomic<float>    m_peakLoad        = 0.0f;
+        std::atomic<uint32_t> m_streamUnderruns = 0; // counted by Music
+        std::atomic<bool>     m_resetPeaks      = false;
+        int64_t               m_lastCallback    = 0; // audio thread only
+
+        // sampled once per frame on the game thread
+        uint32_t m_activeVoices  = 0;
+        uint32_t m_virtualVoices = 0;
+        uint32_t m_peakVoices    = 0;
+
+        glm::vec2 m_listener    = {};
+        float     m_panDistance = DEFAULT_PAN_DISTANCE;
+
+        // decodes music ahead of the audio thread. the lock only guards
+        // the list, decoding happens outside of it
+        std::thread             m_streamThread = {};
+        mutable std::mutex      m_streamMutex  = {};
+        std::condition_variable m_streamWake   = {};
+        std::condition_variable m_refillDone   = {};
+        std::vector<Music*>     m_streams      = {};
+        Music*                  m_refilling    = nullptr; // being decoded right now
+        bool                    m_streaming    = false;
+
+        // voices share the pcm of their sound, only the playback state is per voice
+        std::array<Voice, MAX_VOICES> m_voices            = {};
+        uint64_t                      m_playCount         = 0;
+        uint32_t                      m_newVoices         = 0;
+        uint32_t                      m_newVoicesPerFrame = DEFAULT_NEW_VOICES_PER_FRAME;
 
-        ma_context m_context = {};
-        ma_engine  m_engine  = {};
+        std::vector<Scope<MixerBus>> m_buses = {};
     };
 }
\ No newline at end of file
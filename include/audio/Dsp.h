@@ -0,0 +1,29 @@
+#pragma once
+
+#include "core/Base.h"
+
+//NOTE: SSE2 on x86, NEON on ARM, plain loops everywhere else. only mono and
+//      stereo take the vector paths, other layouts fall back to scalar
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define SAL_DSP_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #define SAL_DSP_NEON
+#endif
+
+namespace sal::dsp
+{
+    static constexpr uint32_t MAX_CHANNELS = 8;
+
+    //NOTE: one pole low pass over interleaved frames, state holds the last
+    //      output of every channel. the recursion is unrolled four frames
+    //      at a time so the vector paths do not wait on every sample
+    void lowPass(float* samples, uint32_t frameCount, uint32_t channels, float coefficient, float* state);
+
+    float lowPassCoefficient(float cutoff, uint32_t sampleRate);
+
+    //NOTE: largest absolute sample of the block, all channels together
+    float peak(const float* samples, uint32_t frameCount, uint32_t channels);
+
+    //NOTE: multiplies frame i by gain + i * step
+    void gainRamp(float* samples, uint32_t frameCount, uint32_t channels, float gain, float step);
+}
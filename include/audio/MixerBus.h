@@ -0,0 +1,128 @@
+#pragma once
+
+#include "audio/Dsp.h"
+#include "core/Base.h"
+
+#include <atomic>
+
+#include <miniaudio.h>
+
+namespace sal
+{
+    class AudioDevice;
+
+    struct CompressorParams
+    {
+        float threshold = -18.0f; // dB
+        float ratio     = 4.0f;
+        float attack    = 5.0f;   // ms
+        float release   = 100.0f; // ms
+        float makeup    = 0.0f;   // dB
+    };
+
+    //NOTE: effect nodes sit between a bus and its parent and always stay in
+    //      the graph, disabled ones pass audio through untouched
+    class LowPassNode
+    {
+    public:
+        ma_result Init(ma_engine& engine);
+        void Uninit();
+
+        //NOTE: 0 disables the filter
+        void SetCutoff(float cutoff) { m_cutoff.store(cutoff, std::memory_order_relaxed); }
+
+        ma_node* Node() { return &m_base; }
+    private:
+        static ma_node_vtable s_vtable;
+
+        static void OnProcess(ma_node* node, const float** input, ma_uint32* inputFrames, float** output, ma_uint32* outputFrames);
+    private:
+        // has to stay the first member, miniaudio casts to it
+        ma_node_base m_base = {};
+
+        uint32_t m_channels   = 0;
+        uint32_t m_sampleRate = 0;
+
+        std::atomic<float>                    m_cutoff = 0.0f;
+        std::array<float, dsp::MAX_CHANNELS> m_state  = {};
+    };
+
+    class CompressorNode
+    {
+    public:
+        //NOTE: gain is recomputed every CONTROL_FRAMES and ramped in between
+        static constexpr uint32_t CONTROL_FRAMES = 32;
+
+        ma_result Init(ma_engine& engine);
+        void Uninit();
+
+        void SetParams(const CompressorParams& params);
+        void SetEnabled(bool enabled) { m_enabled.store(enabled, std::memory_order_relaxed); }
+
+        ma_node* Node() { return &m_base; }
+    private:
+        static ma_node_vtable s_vtable;
+
+        static void OnProcess(ma_node* node, const float** input, ma_uint32* inputFrames, float** output, ma_uint32* outputFrames);
+    private:
+        ma_node_base m_base = {};
+
+        uint32_t m_channels   = 0;
+        uint32_t m_sampleRate = 0;
+
+        // written by the game thread, read by the audio thread
+        std::atomic<bool>  m_enabled   = false;
+        std::atomic<float> m_threshold = -18.0f;
+        std::atomic<float> m_ratio     = 4.0f;
+        std::atomic<float> m_attack    = 5.0f;
+        std::atomic<float> m_release   = 100.0f;
+        std::atomic<float> m_makeup    = 0.0f;
+
+        // audio thread only
+        float m_envelope = -96.0f;
+        float m_gain     = 1.0f;
+    };
+
+    //NOTE: a group of voices mixed together, then run through the low pass
+    //      and compressor and handed to the parent bus or the master output.
+    //      created and owned by AudioDevice, the graph can be changed while
+    //      playing
+    class MixerBus
+    {
+    public:
+        void SetVolume(float volume);
+        void SetPan(float pan);
+
+        //NOTE: null routes the bus straight to the master output
+        void SetParent(MixerBus* parent);
+        MixerBus* Parent() const { return m_parent; }
+
+        void SetLowPass(float cutoff) { m_lowPass.SetCutoff(cutoff); }
+        void SetCompressor(const CompressorParams& params);
+        void DisableCompressor() { m_compressor.SetEnabled(false); }
+
+        //NOTE: where sounds and child buses connect to
+        ma_sound_group* Group() { return &m_group; }
+    private:
+        friend class AudioDevice;
+
+        explicit MixerBus(AudioDevice& device);
+
+        bool Init(MixerBus* parent);
+        void Uninit();
+
+        //NOTE: disconnects the bus from its parent or the master output
+        void Detach();
+    private:
+        AudioDevice& m_device;
+        MixerBus*    m_parent = nullptr;
+
+        ma_sound_group m_group      = {};
+        LowPassNode    m_lowPass    = {};
+        CompressorNode m_compressor = {};
+
+        bool m_groupReady      = false;
+        bool m_lowPassReady    = false;
+        bool m_compressorReady = false;
+    };
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "core/Base.h"
+
+#include <atomic>
+
+#include <miniaudio.h>
+
+namespace sal
+{
+    class AudioDevice;
+    class MixerBus;
+
+    //NOTE: decodes on the audio device's streaming thread into a small ring
+    //      buffer that the mixer reads from, so memory stays the same no
+    //      matter how long the track is. not copyable or movable, miniaudio
+    //      keeps pointers into it
+    class Music
+    {
+    public:
+        static constexpr uint32_t RING_FRAMES = 16384;
+
+        ~Music();
+
+        Music(const Music& other) = delete;
+        Music& operator=(const Music& other) = delete;
+
+        void Play();
+        void Stop();
+        void Seek(uint64_t frame);
+
+        void SetLooping(bool looping) { m_looping.store(looping, std::memory_order_relaxed); }
+        void SetVolume(float volume);
+
+        //NOTE: null plays straight into the master output
+        void SetBus(MixerBus* bus);
+        MixerBus* Bus() const { return m_bus; }
+
+        bool Playing() const;
+
+        //NOTE: callbacks the stream could not fill and padded with silence
+        uint32_t Underruns() const { return m_underruns.load(std::memory_order_relaxed); }
+
+        static Ref<Music> Load(AudioDevice& device, std::string_view filename);
+
+        //NOTE: data is decoded in place and has to outlive the music, this
+        //      is meant for packed or memory mapped files
+        static Ref<Music> Load(AudioDevice& device, const void* data, size_t size);
+    private:
+        friend class AudioDevice;
+
+        static constexpr uint64_t NO_SEEK = ~0ull;
+
+        // the data source handed to ma_sound, base has to come first
+        struct Stream
+        {
+            ma_data_source_base base;
+            Music*              music;
+        };
+
+        static ma_data_source_vtable s_vtable;
+
+        static ma_result StreamRead(ma_data_source* source, void* output, ma_uint64 frameCount, ma_uint64* framesRead);
+        static ma_result StreamSeek(ma_data_source* source, ma_uint64 frame);
+        static ma_result StreamGetDataFormat(ma_data_source* source, ma_format* format, ma_uint32* channels, ma_uint32* sampleRate, ma_channel* channelMap, size_t channelMapCap);
+
+        explicit Music(AudioDevice& device);
+
+        bool Init();
+
+        // audio thread
+        ma_result Read(float* output, uint64_t frameCount, uint64_t* framesRead);
+
+        // streaming thread
+        void Refill();
+    private:
+        AudioDevice& m_device;
+        MixerBus*    m_bus = nullptr;
+
+        ma_decoder m_decoder = {};
+        ma_pcm_rb  m_ring    = {};
+        Stream     m_stream  = {};
+        ma_sound   m_sound   = {};
+
+        uint32_t m_channels   = 0;
+        uint32_t m_sampleRate = 0;
+
+        bool m_decoderReady = false;
+        bool m_ringReady    = false;
+        bool m_streamReady  = false;
+        bool m_soundReady   = false;
+
+        std::atomic<bool>     m_looping   = false;
+        std::atomic<bool>     m_finished  = false;
+        std::atomic<uint64_t> m_seek      = NO_SEEK;
+        std::atomic<uint32_t> m_underruns = 0;
+    };
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "core/Base.h"
+
+#include <mutex>
+
+namespace sal
+{
+    //NOTE: recycles pcm buffers so loading and unloading levels does not
+    //      keep hitting the heap with large blocks. every power of two is
+    //      split into four classes, so a block wastes at most a quarter of
+    //      its size. thread safe, loads allocate from worker threads
+    class PcmAllocator
+    {
+    public:
+        static constexpr size_t MIN_CLASS_SIZE   = 1024;
+        static constexpr size_t CLASS_STEPS      = 4;  // classes per power of two
+        static constexpr size_t CLASS_COUNT      = 53; // up to 8 MB, larger blocks bypass the pool
+        static constexpr size_t MAX_CACHED_BYTES = 32 * 1024 * 1024;
+
+        PcmAllocator() = default;
+        ~PcmAllocator();
+
+        PcmAllocator(const PcmAllocator& other) = delete;
+        PcmAllocator& operator=(const PcmAllocator& other) = delete;
+
+        void* Allocate(size_t size);
+
+        //NOTE: blocks beyond MAX_CACHED_BYTES go straight back to the heap
+        void Free(void* data, size_t size);
+
+        //NOTE: returns every cached block to the heap
+        void Trim();
+
+        size_t CachedBytes() const;
+    private:
+        static size_t SizeClass(size_t size);
+        static size_t ClassSize(size_t sizeClass);
+    private:
+        mutable std::mutex                          m_mutex  = {};
+        std::array<std::vector<void*>, CLASS_COUNT> m_free   = {};
+        size_t                                      m_cached = 0;
+    };
+}
@@ -1,13 +1,13 @@
 #pragma once
 
+#include "audio/AudioDevice.h"
 #include "core/Base.h"
+#include "core/JobSystem.h"
 
 #include <miniaudio.h>
 
 namespace sal
 {
-    class AudioDevice;
-
     enum class EAudioFormat
     {
         NONE,
@@ -16,8 +16,26 @@ namespace sal
         S24,
         S32,
         F32,
+        IMA_ADPCM, // s16 compressed 4:1, see Adpcm.h
     };
 
+    enum class SoundStorage
+    {
+        NATIVE, // whatever the file holds
+        S16,
+        ADPCM,
+    };
+
+    struct SoundLoadOptions
+    {
+        SoundStorage storage = SoundStorage::NATIVE;
+
+        // converts to the device rate once so voices skip the resampler
+        bool resample = true;
+    };
+
+    //NOTE: data has to come from the device's PcmAllocator, the sound
+    //      takes ownership of it and gives it back on destruction
     struct SoundDesc
     {
         EAudioFormat format;
@@ -25,20 +43,80 @@ namespace sal
         uint32_t     sampleRate;
         size_t       frameCount;
         void*        data;
+        size_t       size;
     };
 
+    class Sound;
+
+    //NOTE: handle to a decode running on the job system, poll it every
+    //      frame or block on Wait. without job workers the decode already
+    //      finished when LoadAsync returns
+    class SoundLoad
+    {
+    public:
+        SoundLoad(AudioDevice& device, JobSystem& jobs);
+
+        SoundLoad(const SoundLoad& other) = delete;
+        SoundLoad& operator=(const SoundLoad& other) = delete;
+
+        bool Done() const { return m_result->counter.Done(); }
+        bool Ready() const { return Done() && m_result->decoded; }
+        bool Failed() const { return Done() && !m_result->decoded; }
+
+        //NOTE: only call these once Done. the sound is created by the first
+        //      Get, so it never lives or dies on a worker thread
+        Ref<Sound> Get();
+        const std::string& Error() const { return m_result->error; }
+
+        //NOTE: runs other jobs while waiting
+        void Wait();
+    private:
+        friend class Sound;
+
+        // everything the job touches. the job keeps it alive past Finish,
+        // so it must never own the Sound, only the pcm before Get takes it
+        struct Result
+        {
+            explicit Result(AudioDevice& device) : device(device) {}
+            ~Result();
+
+            AudioDevice& device;
+            JobCounter   counter = {};
+            SoundDesc    desc    = {};
+            bool         decoded = false;
+            bool         taken   = false;
+            std::string  error   = {};
+        };
+
+        JobSystem&  m_jobs;
+        Ref<Result> m_result = {};
+        Ref<Sound>  m_sound  = {};
+    };
+
+    //NOTE: holds the decoded pcm, every Play gets its own voice from the
+    //      device pool that reads from it, so a sound can overlap itself
     class Sound
     {
     public:
         Sound(AudioDevice& device, const SoundDesc& desc);
         ~Sound();
 
-        void Play();
+        //NOTE: not copyable, voices point into the pcm
+        Sound(const Sound& other) = delete;
+        Sound& operator=(const Sound& other) = delete;
 
-        static Ref<Sound> Load(AudioDevice& device, std::string_view filename);
+        VoiceHandle Play(const PlayParams& params = {});
+
+        const SoundDesc& Desc() const { return m_desc; }
+
+        //NOTE: returns null and prints the reason if the file could not be
+        //      decoded
+        static Ref<Sound> Load(AudioDevice& device, std::string_view filename, const SoundLoadOptions& options = {});
+        static Ref<SoundLoad> LoadAsync(AudioDevice& device, JobSystem& jobs, std::string_view filename, const SoundLoadOptions& options = {});
+    private:
+        static bool Decode(AudioDevice& device, const std::string& filename, const SoundLoadOptions& options, SoundDesc& desc, std::string& error);
     private:
-        SoundDesc       m_desc   = {};
-        ma_audio_buffer m_buffer = {};
-        ma_sound        m_sound  = {};
+        AudioDevice& m_device;
+        SoundDesc    m_desc = {};
     };
 }
\ No newline at end of file
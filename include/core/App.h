@@ -1,5 +1,7 @@
 #pragma once
 
+#include "core/FrameHistory.h"
+#include "core/JobSystem.h"
 #include "core/Window.h"
 #include "core/Input.h"
 #include "audio/AudioDevice.h"
@@ -16,6 +18,57 @@ namespace sal {
         int         windowWidth  = 640;
         int         windowHeight = 480;
         const char* windowTitle  = "WINDOW";
+
+        // render offscreen without a visible window or display server
+        bool headless = false;
+
+        // stop after this many frames and print timing results, 0 runs
+        // until the window closes
+        uint32_t frameLimit = 0;
+
+        // simulation step in seconds for FixedUpdate, 0 disables it
+        float fixedTimestep = 0.0f;
+
+        // caps on the simulation work done in one frame, once hit the
+        // simulation runs slower than real time instead of spiraling
+        int   maxFixedSteps = 5;
+        float maxFrameTime  = 0.25f;
+
+        // frame pacing, targetFps limits the frame rate on top of vsync
+        // (0 is unlimited)
+        VSyncMode vsync     = VSyncMode::OFF;
+        float     targetFps = 0.0f;
+
+        // block on input instead of spinning while Window::SetAnimating is
+        // false, waking up at least every idleTimeout seconds
+        bool  waitForEvents = false;
+        float idleTimeout   = 0.5f;
+
+        // worker threads for the job system, -1 picks one per hardware
+        // thread minus the main thread
+        int jobWorkers = -1;
+
+        // samples the cursor again right before Render, so anything that
+        // follows it is a frame fresher. see Renderer2D::DrawCursorTexture
+        bool lateInput = false;
+
+        // prints the time from input being read to the frame showing it
+        // being presented. waits for the gpu after every swap
+        bool measureInputLatency = false;
+
+        // linked shader programs are cached here as driver binaries when
+        // GL_OES_get_program_binary is available, null compiles every launch
+        const char* shaderCacheDirectory = nullptr;
+
+        // headless forces the null backend on top of this
+        AudioSettings audio = {};
+
+        // writes every input event and frame delta to this file
+        const char* recordInput = nullptr;
+
+        // plays a recording back instead of live input, frames use the
+        // recorded deltas and the app quits when it runs out
+        const char* replayInput = nullptr;
     };
 
     class App {
@@ -23,19 +76,39 @@ namespace sal {
         App(const Settings& settings = {});
         virtual ~App() = default;
 
+        //NOTE: premultiply multiplies color by alpha while decoding, for
+        //      drawing with BlendMode::PREMULTIPLIED
         //TODO: texture loading hack
-        Ref<Texture> LoadTexture(const char* filename);
+        Ref<Texture> LoadTexture(const char* filename, bool premultiply = false);
+
+        //NOTE: decodes on the job system, uploads on the calling thread.
+        //      entries that failed to load are empty
+        std::vector<Ref<Texture>> LoadTextures(const std::vector<const char*>& filenames, bool premultiply = false);
 
         void Run();
+        static void Quit();
 
-        virtual void Init()              = 0;
-        virtual void Shutdown()          = 0;
-        virtual void Update(float delta) = 0;
+        virtual void Init()     = 0;
+        virtual void Shutdown() = 0;
+
+        //NOTE: called once per frame with the variable frame time
+        virtual void Update(float delta) {}
+
+        //NOTE: only called with Settings::fixedTimestep set, zero or more
+        //      times per frame with a constant step
+        virtual void FixedUpdate(float step) {}
+
+        //NOTE: called once per frame after the fixed steps, alpha is how far
+        //      the current time is between the last two simulation states
+        //      (always 1 without a fixed timestep)
+        virtual void Render(float alpha) {}
 
         static Window& GetWindow() { return *s_instance->m_window; }
         static Renderer2D& GetRenderer() { return *s_instance->m_renderer; }
         static Input& GetInput() { return *s_instance->m_input; }
         static AudioDevice& GetAudio() { return *s_instance->m_audio; }
+        static JobSystem& GetJobs() { return *s_instance->m_jobs; }
+        static const FrameHistory& GetFrameHistory() { return s_instance->m_frameHistory; }
     private:
         Settings m_settings = {};
 
@@ -43,6 +116,9 @@ namespace sal {
         Scope<Renderer2D> m_renderer = {};
         Scope<Input>         m_input    = {};
         Scope<AudioDevice>   m_audio    = {};
+        Scope<JobSystem>     m_jobs     = {};
+
+        FrameHistory m_frameHistory = {};
 
         static inline App* s_instance = nullptr;
     };
@@ -32,6 +32,19 @@ namespace sal {
         return std::make_unique<T>(std::forward<Args>(args)...);
     }
 
+    struct AABB {
+        glm::vec2 min = {};
+        glm::vec2 max = {};
+    };
+
+    inline bool Overlaps(const AABB& a, const AABB& b) {
+        return a.min.x <= b.max.x && a.max.x >= b.min.x && a.min.y <= b.max.y && a.max.y >= b.min.y;
+    }
+
+    inline bool Contains(const AABB& box, glm::vec2 point) {
+        return point.x >= box.min.x && point.x <= box.max.x && point.y >= box.min.y && point.y <= box.max.y;
+    }
+
     inline glm::mat4 MakeTransform(const glm::vec2& position, const glm::vec2& size, float rotation) {
         glm::mat4 transform(1.0f);
 
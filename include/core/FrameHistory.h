@@ -0,0 +1,49 @@
+#pragma once
+
+#include "core/Base.h"
+
+namespace sal {
+
+    struct SampleSummary {
+        size_t count   = 0;
+        double total   = 0.0;
+        float  average = 0.0f;
+        float  min     = 0.0f;
+        float  p50     = 0.0f;
+        float  p90     = 0.0f;
+        float  p99     = 0.0f;
+        float  max     = 0.0f;
+    };
+
+    //NOTE: nearest rank, the index of a percentile in [0, 1] within count
+    //      sorted samples. every percentile the engine reports uses it
+    size_t PercentileIndex(size_t count, float percentile);
+
+    //NOTE: sorts the samples in place
+    SampleSummary Summarize(std::vector<float>& samples);
+
+    //NOTE: rolling window of the most recent frame times in seconds
+    class FrameHistory {
+    public:
+        static constexpr size_t CAPACITY = 256;
+
+        void Push(float frameTime);
+        void Clear();
+
+        size_t Count() const { return m_count; }
+        float Latest() const;
+
+        float Min() const;
+        float Max() const;
+        float Average() const;
+
+        //NOTE: percentile in [0, 1], e.g. 0.99 for p99
+        float Percentile(float percentile) const;
+    private:
+        std::array<float, CAPACITY> m_frameTimes = {};
+
+        size_t m_head  = 0;
+        size_t m_count = 0;
+    };
+
+}
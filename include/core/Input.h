@@ -1,18 +1,78 @@
 #pragma once
 
 #include "core/Base.h"
+#include "core/SpscQueue.h"
 
 namespace sal {
 
+    class InputRecorder;
+
+    enum class InputEventType : uint8_t {
+        KEY,
+        MOUSE_BUTTON,
+        MOUSE_MOVE,
+        SCROLL,
+        CHAR,
+    };
+
+    enum class InputAction : uint8_t {
+        PRESS,
+        RELEASE,
+        REPEAT,
+    };
+
+    //NOTE: code is the key, mouse button or unicode codepoint. position is
+    //      the cursor for MOUSE_MOVE and the offset for SCROLL. time is in
+    //      seconds on the Window::Time clock, taken when the event was read
+    //      from the os
+    struct InputEvent {
+        InputEventType type     = InputEventType::KEY;
+        InputAction    action   = InputAction::PRESS;
+        int            code     = 0;
+        int            mods     = 0;
+        glm::vec2      position = {};
+        double         time     = 0.0;
+    };
+
     class Input {
     public:
+        static constexpr uint32_t EVENT_QUEUE_SIZE = 1024;
+
         void Reset();
 
+        //NOTE: producer side, called by the window callbacks. updates the
+        //      polling state and queues the event
+        void PushEvent(const InputEvent& event);
+
+        //NOTE: consumer side, returns false once the queue is empty. events
+        //      not polled by the end of the frame are discarded by Reset,
+        //      events that do not fit within one frame are dropped and counted
+        bool PollEvent(InputEvent& event) { return m_events.Pop(event); }
+        uint32_t DroppedEvents() const { return m_droppedEvents.load(std::memory_order_relaxed); }
+
+        //NOTE: every live event is handed to the recorder, null stops
+        void SetRecorder(InputRecorder* recorder) { m_recorder = recorder; }
+
+        //NOTE: while replaying live events are ignored and only ReplayEvent
+        //      changes the input state
+        void SetReplaying(bool replaying) { m_replaying = replaying; }
+        void ReplayEvent(const InputEvent& event);
+
+        //NOTE: overrides the mouse position with a fresher sample between
+        //      events. pushed as a MOUSE_MOVE, so it is recorded and ignored
+        //      while replaying
+        void LatchMousePosition(glm::vec2 position, double time);
+
+        //NOTE: Window::Time of the newest event or latch that reached the
+        //      input state
+        double SampleTime() const { return m_sampleTime; }
+
         void SetMousePosition(const glm::vec2& position);
         void SetKey(int key, bool isDown, bool wasDown);
         void SetMouseButton(int button, bool isDown, bool wasDown);
 
         glm::vec2 MousePosition() const { return m_mousePosition; }
+        glm::vec2 ScrollDelta() const { return m_scrollDelta; }
 
         bool KeyDown(int key) const;
         bool KeyPressed(int key) const;
@@ -21,11 +81,21 @@ namespace sal {
         bool MouseButtonDown(int button) const;
         bool MouseButtonPressed(int button) const;
         bool MouseButtonReleased(int button) const;
+    private:
+        void Apply(const InputEvent& event);
     private:
         static constexpr int KEY_BUFFER_SIZE    = 256;
         static constexpr int BUTTON_BUFFER_SIZE = 8;
 
         glm::vec2 m_mousePosition = {};
+        glm::vec2 m_scrollDelta   = {};
+        double    m_sampleTime    = 0.0;
+
+        SpscQueue<InputEvent, EVENT_QUEUE_SIZE> m_events        = {};
+        std::atomic<uint32_t>                   m_droppedEvents = 0;
+
+        InputRecorder* m_recorder  = nullptr;
+        bool           m_replaying = false;
 
         std::array<bool, KEY_BUFFER_SIZE> m_keysDown     = {};
         std::array<bool, KEY_BUFFER_SIZE> m_keysPressed  = {};
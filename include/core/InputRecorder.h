@@ -0,0 +1,82 @@
+#pragma once
+
+#include "core/Base.h"
+#include "core/Input.h"
+
+#include <cstdio>
+
+namespace sal {
+
+    //NOTE: a recording is a header followed by one record per frame: the
+    //      frame's delta, then the events read since the previous frame.
+    //      event times are stored relative to the start of their frame.
+    //      little endian, not meant to be portable between machines
+    struct InputRecordingHeader {
+        char     magic[4] = { 'S', 'A', 'L', 'I' };
+        uint32_t version  = 1;
+    };
+
+    struct RecordedInputEvent {
+        uint8_t  type;
+        uint8_t  action;
+        uint16_t mods;
+        int32_t  code;
+        float    x;
+        float    y;
+        float    time;
+    };
+
+    //NOTE: events are buffered and written out once per frame, so a crash
+    //      loses at most the current frame
+    class InputRecorder {
+    public:
+        ~InputRecorder();
+
+        InputRecorder(const InputRecorder& other) = delete;
+        InputRecorder& operator=(const InputRecorder& other) = delete;
+
+        //NOTE: called by Input for every live event
+        void Record(const InputEvent& event);
+
+        //NOTE: called by App at the start of every frame, now is Window::Time
+        void EndFrame(float delta, double now);
+
+        uint32_t FrameCount() const { return m_frames; }
+
+        //NOTE: returns null and prints the reason if the file can not be
+        //      written
+        static Scope<InputRecorder> Create(std::string_view filename);
+    private:
+        explicit InputRecorder(FILE* file);
+    private:
+        FILE*                           m_file   = nullptr;
+        std::vector<InputEvent>         m_events = {};
+        std::vector<RecordedInputEvent> m_packed = {};
+        uint32_t                        m_frames = 0;
+    };
+
+    class InputReplay {
+    public:
+        bool Done() const { return m_frame >= m_frames.size(); }
+        uint32_t FrameCount() const { return (uint32_t)m_frames.size(); }
+
+        //NOTE: feeds the next frame's events into input and returns the
+        //      recorded delta, now is Window::Time
+        float NextFrame(Input& input, double now);
+
+        //NOTE: returns null and prints the reason if the file is missing,
+        //      corrupt or from another version
+        static Scope<InputReplay> Load(std::string_view filename);
+    private:
+        struct Frame {
+            float    delta;
+            uint32_t first;
+            uint32_t count;
+        };
+
+        std::vector<Frame>              m_frames = {};
+        std::vector<RecordedInputEvent> m_events = {};
+        size_t                          m_frame  = 0;
+    };
+
+}
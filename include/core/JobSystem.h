@@ -0,0 +1,112 @@
+#pragma once
+
+#include "core/Base.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace sal {
+
+    using Job = std::function<void()>;
+
+    class JobSystem;
+
+    //NOTE: counts the unfinished jobs started with it, jobs can also be
+    //      made to wait for a counter to reach zero before they are queued.
+    //      only destroy a counter after JobSystem::Wait returned on it
+    class JobCounter {
+    public:
+        JobCounter() = default;
+
+        //NOTE: not copyable
+        JobCounter(const JobCounter& other) = delete;
+        JobCounter& operator=(const JobCounter& other) = delete;
+
+        bool Done() const { return m_pending.load(std::memory_order_acquire) == 0; }
+    private:
+        friend class JobSystem;
+
+        struct Continuation {
+            Job         job;
+            JobCounter* counter;
+        };
+
+        std::atomic<uint32_t>     m_pending       = 0;
+        std::mutex                m_mutex         = {};
+        std::vector<Continuation> m_continuations = {};
+    };
+
+    //NOTE: every worker owns a deque, it pushes and pops its own jobs at
+    //      the back and steals from the front of the others when empty.
+    //      threads waiting on a counter run jobs instead of blocking
+    class JobSystem {
+    public:
+        //NOTE: -1 uses one worker per hardware thread minus the caller
+        void Init(int workerCount = -1);
+        void Shutdown();
+
+        uint32_t WorkerCount() const { return (uint32_t)m_workers.size(); }
+
+        void Run(Job job, JobCounter* counter = nullptr);
+
+        //NOTE: job is queued once dependency is done
+        void RunAfter(JobCounter& dependency, Job job, JobCounter* counter = nullptr);
+
+        void Wait(JobCounter& counter);
+
+        //NOTE: calls fn(begin, end) on ranges of at most grain items and
+        //      returns once all of them are done
+        template<typename Fn>
+        void ParallelFor(uint32_t count, uint32_t grain, Fn&& fn) {
+            if (count == 0) {
+                return;
+            }
+
+            grain = grain > 0 ? grain : 1;
+
+            if (m_workers.empty() || count <= grain) {
+                fn(0u, count);
+                return;
+            }
+
+            JobCounter counter;
+
+            for (uint32_t begin = 0; begin < count; begin += grain) {
+                uint32_t end = begin + grain < count ? begin + grain : count;
+                Run([&fn, begin, end]() { fn(begin, end); }, &counter);
+            }
+
+            Wait(counter);
+        }
+    private:
+        struct Task {
+            Job         job;
+            JobCounter* counter;
+        };
+
+        struct Queue {
+            std::mutex       mutex = {};
+            std::deque<Task> tasks = {};
+        };
+
+        void Push(Task task);
+        bool TryRunOne();
+        void Finish(JobCounter* counter);
+        void WorkerLoop(uint32_t index);
+    private:
+        std::vector<std::thread> m_workers = {};
+
+        // queue 0 is shared by threads that are not workers
+        std::vector<Scope<Queue>> m_queues = {};
+
+        std::atomic<uint32_t>   m_queued     = 0;
+        std::atomic<bool>       m_running    = false;
+        std::mutex              m_sleepMutex = {};
+        std::condition_variable m_wake       = {};
+    };
+
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "core/Base.h"
+
+#include <atomic>
+#include <chrono>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    #include <intrin.h>
+    #define SAL_PROFILER_TSC
+#elif defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h>
+    #define SAL_PROFILER_TSC
+#endif
+
+namespace sal {
+
+    struct ProfileZone {
+        const char* name;
+        uint64_t    start;
+        uint64_t    end;
+    };
+
+    //NOTE: every thread records into its own ring buffer so recording never
+    //      takes a lock, old zones are overwritten once a buffer wraps around
+    class Profiler {
+    public:
+        static constexpr size_t ZONES_PER_THREAD = 1 << 16;
+
+        //NOTE: raw ticks, the tsc is read directly where available since it
+        //      is roughly half the cost of steady_clock. ticks are converted
+        //      to time when the trace is written
+        static uint64_t Now() {
+#ifdef SAL_PROFILER_TSC
+            return __rdtsc();
+#else
+            return (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+        }
+
+        static void Record(const char* name, uint64_t start, uint64_t end);
+        static void SetThreadName(const char* name);
+
+        //NOTE: zones recorded by other threads while writing may be torn,
+        //      call this at a quiet point (e.g. between frames)
+        static bool WriteChromeTrace(const char* filename);
+    };
+
+    class ProfileScope {
+    public:
+        ProfileScope(const char* name) : m_name(name), m_start(Profiler::Now()) {}
+        ~ProfileScope() { Profiler::Record(m_name, m_start, Profiler::Now()); }
+
+        //NOTE: not copyable
+        ProfileScope(const ProfileScope& other) = delete;
+        ProfileScope& operator=(const ProfileScope& other) = delete;
+    private:
+        const char* m_name  = nullptr;
+        uint64_t    m_start = 0;
+    };
+
+}
+
+#define SAL_PROFILE_CONCAT_INNER(a, b) a##b
+#define SAL_PROFILE_CONCAT(a, b) SAL_PROFILE_CONCAT_INNER(a, b)
+
+#ifdef SAL_ENABLE_PROFILER
+    #define SAL_PROFILE_SCOPE(name) ::sal::ProfileScope SAL_PROFILE_CONCAT(profileScope, __LINE__)(name)
+    #define SAL_PROFILE_FUNCTION() SAL_PROFILE_SCOPE(__func__)
+    #define SAL_PROFILE_THREAD(name) ::sal::Profiler::SetThreadName(name)
+#else
+    #define SAL_PROFILE_SCOPE(name)
+    #define SAL_PROFILE_FUNCTION()
+    #define SAL_PROFILE_THREAD(name)
+#endif
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "core/Base.h"
+#include "core/JobSystem.h"
+
+namespace sal {
+
+    //NOTE: uniform grid broadphase, cells are hashed so the grid has no
+    //      bounds. objects go into every cell they touch so the cell size
+    //      should be close to the size of a typical object. rebuilt from
+    //      scratch every frame, the memory is kept between builds
+    class SpatialHash {
+    public:
+        void SetCellSize(float size);
+        float CellSize() const { return m_cellSize; }
+
+        //NOTE: object ids are indices into bounds, the bounds are copied.
+        //      the per object passes are split across jobs
+        void Build(JobSystem& jobs, const AABB* bounds, uint32_t count);
+        void Clear();
+
+        uint32_t Count() const { return (uint32_t)m_bounds.size(); }
+        const AABB& Bounds(uint32_t object) const { return m_bounds[object]; }
+
+        //NOTE: queries append to the output and report each object once,
+        //      pairs are ordered by id with first < second
+        void QueryRange(const AABB& range, std::vector<uint32_t>& results) const;
+        void QueryPoint(glm::vec2 point, std::vector<uint32_t>& results) const;
+        void QueryPairs(std::vector<std::pair<uint32_t, uint32_t>>& pairs) const;
+    private:
+        struct CellRange {
+            glm::ivec2 min;
+            glm::ivec2 max;
+        };
+
+        struct Entry {
+            glm::ivec2 cell;
+            uint32_t   object;
+        };
+
+        glm::ivec2 Cell(glm::vec2 point) const;
+        CellRange Cells(const AABB& bounds) const;
+        uint32_t Bucket(glm::ivec2 cell) const;
+    private:
+        float m_cellSize        = 64.0f;
+        float m_inverseCellSize = 1.0f / 64.0f;
+
+        std::vector<AABB>      m_bounds  = {};
+        std::vector<CellRange> m_ranges  = {};
+
+        // entries grouped by object, offsets are a prefix sum over objects
+        std::vector<uint32_t> m_offsets = {};
+        std::vector<Entry>    m_entries = {};
+
+        // the same entries grouped by bucket, buckets are a prefix sum as well
+        uint32_t              m_bucketMask = 0;
+        std::vector<uint32_t> m_buckets    = {};
+        std::vector<uint32_t> m_cursors    = {};
+        std::vector<Entry>    m_sorted     = {};
+    };
+
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "core/Base.h"
+
+#include <atomic>
+
+namespace sal {
+
+    //NOTE: fixed size ring for exactly one producer and one consumer thread,
+    //      neither side ever blocks. Push fails when full and Pop when empty.
+    //      each side caches the other's index so it only touches the shared
+    //      cache line when the cached value runs out
+    template<typename T, uint32_t CAPACITY>
+    class SpscQueue {
+    public:
+        static_assert(CAPACITY > 0 && (CAPACITY & (CAPACITY - 1)) == 0, "capacity has to be a power of two");
+
+        // producer
+        bool Push(const T& value) {
+            uint32_t head = m_head.load(std::memory_order_relaxed);
+
+            if (head - m_tailCache == CAPACITY) {
+                m_tailCache = m_tail.load(std::memory_order_acquire);
+
+                if (head - m_tailCache == CAPACITY) {
+                    return false;
+                }
+            }
+
+            m_items[head & MASK] = value;
+            m_head.store(head + 1, std::memory_order_release);
+
+            return true;
+        }
+
+        // consumer
+        bool Pop(T& value) {
+            uint32_t tail = m_tail.load(std::memory_order_relaxed);
+
+            if (tail == m_headCache) {
+                m_headCache = m_head.load(std::memory_order_acquire);
+
+                if (tail == m_headCache) {
+                    return false;
+                }
+            }
+
+            value = m_items[tail & MASK];
+            m_tail.store(tail + 1, std::memory_order_release);
+
+            return true;
+        }
+
+        // consumer, drops everything pushed so far
+        void Clear() {
+            m_headCache = m_head.load(std::memory_order_acquire);
+            m_tail.store(m_headCache, std::memory_order_release);
+        }
+
+        //NOTE: only a snapshot while the other side is running
+        uint32_t Size() const { return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire); }
+        bool Empty() const { return Size() == 0; }
+    private:
+        static constexpr uint32_t MASK = CAPACITY - 1;
+
+        // indices only ever grow and wrap around, their difference stays
+        // valid. producer and consumer state sit on separate cache lines
+        alignas(64) std::atomic<uint32_t> m_head = 0;
+        uint32_t m_tailCache = 0;
+
+        alignas(64) std::atomic<uint32_t> m_tail = 0;
+        uint32_t m_headCache = 0;
+
+        alignas(64) std::array<T, CAPACITY> m_items = {};
+    };
+
+}
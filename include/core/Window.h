@@ -1,26 +1,67 @@
 #pragma once
 
+#include "graphics/gpu.h"
+
+#include <atomic>
+
 struct GLFWwindow;
 
 namespace sal {
 
+    struct Settings;
+
+    enum class VSyncMode {
+        OFF,
+        ON,
+        ADAPTIVE, // needs swap_control_tear, never available on EGL, runs as ON
+    };
+
     class Window {
     public:
-        void Init(int width, int height, const char* title);
+        void Init(const Settings& settings);
         void Shutdown();
 
         void SwapBuffers();
+
+        //NOTE: reads the cursor straight from the os into Input, for
+        //      sampling it later than the last event poll. does nothing
+        //      unless Settings::lateInput is set
+        void LatchCursor();
         bool Running();
+        void Close();
 
         void SetSize(int width, int height);
 
+        //NOTE: only matters with Settings::waitForEvents, while nothing is
+        //      animating frames are only produced for input, RequestFrame
+        //      or after Settings::idleTimeout
+        void SetAnimating(bool animating) { m_animating = animating; }
+        void RequestFrame();
+
         int Width() const { return m_width; }
         int Height() const { return m_height; }
 
         float XScale() const { return m_xscale; }
         float YScale() const { return m_yscale; }
 
+        bool Headless() const { return m_headless; }
+
+        //NOTE: the mode actually in use, ADAPTIVE is reported as ON
+        VSyncMode VSync() const { return m_vsync; }
+
         float FrameTime() const { return m_deltaTime; }
+
+        //NOTE: Time right after the last swap, once the gpu finished with
+        //      Settings::measureInputLatency
+        double PresentTime() const { return m_presentTime; }
+
+        //NOTE: seconds since Init from the monotonic timer, double so it
+        //      keeps sub microsecond precision over long uptimes
+        double Time() const;
+    private:
+        static VSyncMode SupportedVSync(VSyncMode mode);
+        static int SwapInterval(VSyncMode mode);
+        void WaitUntil(double deadline);
     private:
         GLFWwindow* m_handle = nullptr;
 
@@ -30,9 +71,29 @@ namespace sal {
         float m_xscale = 0.0f;
         float m_yscale = 0.0f;
 
+        // headless windows have no surface and render offscreen
+        bool                   m_headless    = false;
+        gpu::FramebufferHandle m_framebuffer = {};
+
+        VSyncMode m_vsync = VSyncMode::OFF;
+
+        bool   m_lateInput       = false;
+        bool   m_finishAfterSwap = false;
+        double m_presentTime     = 0.0;
+
+        // frame pacing
+        double m_targetFrameTime = 0.0;
+        bool   m_waitForEvents   = false;
+        double m_idleTimeout     = 0.0;
+        bool   m_animating       = true;
+
+        // can be requested from other threads to wake up the loop
+        std::atomic<bool> m_frameRequested = false;
+
         //TODO: this might be a little out of place
-        float m_lastTime  = 0.0f;
-        float m_deltaTime = 0.0f;
+        uint64_t m_timerStart = 0;
+        double   m_lastTime   = 0.0;
+        float    m_deltaTime  = 0.0f;
     };
 
 }
\ No newline at end of file
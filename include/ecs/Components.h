@@ -0,0 +1,19 @@
+#pragma once
+
+#include "core/Base.h"
+#include "graphics/TextureRegistry.h"
+
+namespace sal::ecs {
+
+    struct Transform {
+        glm::vec2 position = {};
+        glm::vec2 size     = { 1.0f, 1.0f };
+        float     rotation = 0.0f;
+    };
+
+    struct SpriteRenderer {
+        TextureID texture = {};
+        glm::vec4 color   = { 1.0f, 1.0f, 1.0f, 1.0f };
+    };
+
+}
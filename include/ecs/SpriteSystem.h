@@ -0,0 +1,22 @@
+#pragma once
+
+#include "ecs/Components.h"
+#include "ecs/World.h"
+#include "graphics/Renderer2D.h"
+
+namespace sal::ecs {
+
+    //NOTE: draws every entity with a Transform and a SpriteRenderer in
+    //      storage order, consecutive entities sharing a texture are handed
+    //      to Renderer2D::DrawSprites as one run
+    class SpriteSystem {
+    public:
+        void Render(World& world, Renderer2D& renderer);
+    private:
+        void Submit(Renderer2D& renderer);
+    private:
+        std::vector<Sprite> m_sprites = {};
+        TextureID           m_texture = {};
+    };
+
+}
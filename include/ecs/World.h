@@ -0,0 +1,178 @@
+#pragma once
+
+#include "core/Base.h"
+
+#include <type_traits>
+
+namespace sal::ecs {
+
+    //NOTE: generation 0 is never handed out, a default entity is invalid
+    struct Entity {
+        uint32_t index      = 0;
+        uint32_t generation = 0;
+
+        bool operator==(const Entity& other) const = default;
+    };
+
+    using ComponentID = uint32_t;
+
+    static constexpr uint32_t MAX_COMPONENTS = 64;
+    static constexpr uint32_t CHUNK_SIZE     = 16 * 1024;
+
+    struct ComponentInfo {
+        uint32_t size;
+        uint32_t alignment;
+    };
+
+    ComponentID RegisterComponent(ComponentInfo info);
+    const ComponentInfo& GetComponentInfo(ComponentID id);
+
+    //NOTE: components are moved between chunks with memcpy and never
+    //      destructed, so they have to be plain data
+    template<typename T>
+    ComponentID ComponentType() {
+        static_assert(std::is_trivially_copyable_v<T>, "components must be trivially copyable");
+        static const ComponentID id = RegisterComponent({ .size = sizeof(T), .alignment = alignof(T) });
+        return id;
+    }
+
+    template<typename... Ts>
+    uint64_t ComponentMask() {
+        return (0ull | ... | (1ull << ComponentType<Ts>()));
+    }
+
+    //NOTE: every entity with the same set of components lives in the same
+    //      archetype. its chunks store each component as its own array so
+    //      queries walk contiguous memory
+    class Archetype {
+    public:
+        uint64_t Mask() const { return m_mask; }
+        uint32_t Capacity() const { return m_capacity; }
+
+        size_t ChunkCount() const { return m_chunks.size(); }
+        uint32_t ChunkSize(size_t chunk) const { return m_chunks[chunk].count; }
+
+        Entity* Entities(size_t chunk) { return (Entity*)m_chunks[chunk].data; }
+
+        void* Column(size_t chunk, ComponentID id) { return m_chunks[chunk].data + m_offsets[id]; }
+        void* Element(size_t chunk, uint32_t row, ComponentID id) { return m_chunks[chunk].data + m_offsets[id] + row * m_sizes[id]; }
+
+        template<typename T>
+        T* Column(size_t chunk) { return (T*)Column(chunk, ComponentType<T>()); }
+    private:
+        friend class World;
+
+        struct Chunk {
+            uint8_t* data  = nullptr;
+            uint32_t count = 0;
+        };
+
+        uint64_t                             m_mask       = 0;
+        uint32_t                             m_capacity   = 0;
+        std::vector<ComponentID>             m_components = {};
+        std::array<uint32_t, MAX_COMPONENTS> m_offsets    = {};
+        std::array<uint32_t, MAX_COMPONENTS> m_sizes      = {};
+        std::vector<Chunk>                   m_chunks     = {};
+    };
+
+    //NOTE: creating, destroying or changing the components of entities
+    //      while iterating a query invalidates it
+    class World {
+    public:
+        World() = default;
+        ~World();
+
+        //NOTE: not copyable
+        World(const World& other) = delete;
+        World& operator=(const World& other) = delete;
+
+        template<typename... Ts>
+        Entity Create(const Ts&... components) {
+            Entity entity = Create(ComponentMask<Ts...>());
+            ((*Get<Ts>(entity) = components), ...);
+            return entity;
+        }
+
+        Entity Create(uint64_t mask);
+        void Destroy(Entity entity);
+        void Clear();
+
+        bool Alive(Entity entity) const {
+            return entity.index < m_records.size() && m_records[entity.index].generation == entity.generation;
+        }
+
+        uint32_t Count() const { return m_count; }
+
+        template<typename T>
+        T* Get(Entity entity) { return (T*)GetComponent(entity, ComponentType<T>()); }
+
+        template<typename T>
+        bool Has(Entity entity) { return GetComponent(entity, ComponentType<T>()) != nullptr; }
+
+        template<typename T>
+        void Add(Entity entity, const T& component) {
+            if (!Alive(entity)) {
+                return;
+            }
+
+            Move(entity, m_records[entity.index].archetype->m_mask | ComponentMask<T>());
+            *Get<T>(entity) = component;
+        }
+
+        template<typename T>
+        void Remove(Entity entity) {
+            if (!Alive(entity)) {
+                return;
+            }
+
+            Move(entity, m_records[entity.index].archetype->m_mask & ~ComponentMask<T>());
+        }
+
+        //NOTE: fn(count, entities, Ts*...) once per chunk holding all of Ts
+        template<typename... Ts, typename Fn>
+        void EachChunk(Fn&& fn) {
+            uint64_t mask = ComponentMask<Ts...>();
+
+            for (const Scope<Archetype>& archetype : m_archetypes) {
+                if ((archetype->m_mask & mask) != mask) {
+                    continue;
+                }
+
+                for (size_t chunk = 0; chunk < archetype->ChunkCount(); chunk++) {
+                    fn(archetype->ChunkSize(chunk), (const Entity*)archetype->Entities(chunk), archetype->template Column<Ts>(chunk)...);
+                }
+            }
+        }
+
+        //NOTE: fn(Ts&...) once per entity holding all of Ts
+        template<typename... Ts, typename Fn>
+        void Each(Fn&& fn) {
+            EachChunk<Ts...>([&fn](uint32_t count, const Entity*, Ts*... columns) {
+                for (uint32_t i = 0; i < count; i++) {
+                    fn(columns[i]...);
+                }
+            });
+        }
+    private:
+        struct Record {
+            Archetype* archetype  = nullptr;
+            uint32_t   chunk      = 0;
+            uint32_t   row        = 0;
+            uint32_t   generation = 1;
+        };
+
+        Archetype& GetArchetype(uint64_t mask);
+        void Insert(Archetype& archetype, Entity entity);
+        void Erase(Entity entity);
+        void Move(Entity entity, uint64_t mask);
+
+        void* GetComponent(Entity entity, ComponentID id);
+    private:
+        std::vector<Scope<Archetype>> m_archetypes = {};
+        std::vector<Record>           m_records    = {};
+        std::vector<uint32_t>         m_freeList   = {};
+
+        uint32_t m_count = 0;
+    };
+
+}
@@ -0,0 +1,68 @@
+#ifndef SAL_GRAPHICS_GPUTIMER_H
+#define SAL_GRAPHICS_GPUTIMER_H
+
+#include "graphics/gpu.h"
+
+namespace sal {
+    struct GpuTiming {
+        const char* pass;
+        const char* label;
+        double      milliseconds;
+    };
+
+    struct GpuFrameTimings {
+        uint64_t               frame        = 0;
+        double                 milliseconds = 0.0;
+        std::vector<GpuTiming> passes       = {};
+        std::vector<GpuTiming> batches      = {};
+    };
+
+    //NOTE: results are read back FRAME_LATENCY frames late. a frame whose
+    //      queries are still in flight when its slot comes around again
+    //      is dropped instead of waiting on the gpu
+    class GpuTimer {
+    public:
+        static constexpr int FRAME_LATENCY = 4;
+
+        void Shutdown();
+
+        bool Available() const { return gpu::timerQueriesSupported(); }
+
+        void SetEnabled(bool enabled) { m_enabled = enabled; }
+        bool Enabled() const { return m_enabled && Available(); }
+
+        void BeginFrame();
+
+        //NOTE: timer queries can not nest, a pass is the sum of its batches
+        void BeginBatch(const char* pass, const char* label);
+        void EndBatch();
+
+        //NOTE: the latest frame that resolved, frame == 0 until one has
+        const GpuFrameTimings& Results() const { return m_results; }
+    private:
+        struct Sample {
+            const char* pass;
+            const char* label;
+        };
+
+        struct Frame {
+            std::vector<gpu::QueryHandle> queries = {};
+            std::vector<Sample>           samples = {};
+
+            uint64_t index   = 0;
+            bool     pending = false;
+        };
+
+        bool Resolve(Frame& frame);
+    private:
+        std::array<Frame, FRAME_LATENCY> m_frames = {};
+
+        uint64_t m_frameIndex = 0;
+        bool     m_enabled    = false;
+        bool     m_active     = false;
+
+        GpuFrameTimings m_results = {};
+    };
+}
+
+#endif
@@ -3,9 +3,12 @@
 
 #include "graphics/Camera.h"
 #include "graphics/gpu.h"
+#include "graphics/GpuTimer.h"
 #include "graphics/Shader.h"
+#include "graphics/ShaderVariants.h"
 #include "graphics/Buffer.h"
 #include "graphics/Texture.h"
+#include "graphics/TextureRegistry.h"
 
 namespace sal {
     namespace Color
@@ -17,21 +20,91 @@ namespace sal {
         inline glm::vec4 BLUE  = { 0.0f, 0.0f, 1.0f, 1.0f };
     }
 
+    //NOTE: counters for one frame, everything submitted between two
+    //      BeginFrame calls regardless of how many Begin/End pairs
+    struct RendererStats {
+        uint32_t drawCalls     = 0;
+        uint32_t vertices      = 0;
+        uint32_t indices       = 0;
+        uint64_t bytesUploaded = 0;
+
+        uint32_t flushesForSpace   = 0;
+        uint32_t flushesForMode    = 0;
+        uint32_t flushesForTexture = 0;
+        uint32_t flushesForBlend   = 0;
+
+        uint32_t stateChangesSkipped = 0;
+        uint32_t texturesBound       = 0;
+        uint32_t culledPrimitives    = 0;
+        uint32_t opaqueQuads         = 0;
+    };
+
+    struct Sprite {
+        glm::vec2 position;
+        glm::vec2 size;
+        float     rotation;
+        glm::vec4 color;
+    };
+
     class Renderer2D {
     public:
         void Init();
         void Shutdown();
 
-        void Begin(const Camera& camera);
+        //NOTE: called by App once per frame before Update
+        void BeginFrame();
+
+        //NOTE: pass names are only used to annotate gpu timings and
+        //      must outlive the frame (string literals)
+        void Begin(const Camera& camera, const char* pass = "main");
         void End();
 
+        //NOTE: the registry keeps the texture alive until it is released,
+        //      draw calls only ever see the id
+        TextureID RegisterTexture(Ref<Texture> texture) { return m_textures.Register(std::move(texture)); }
+        void ReleaseTexture(TextureID texture) { m_textures.Unregister(texture); }
+
+        Texture* GetTexture(TextureID texture) const { return m_textures.Get(texture); }
+
         void DrawRect(glm::vec2 position, glm::vec2 size, float rotation, glm::vec4 color);    
-        void DrawTexture(Ref<Texture> texture, glm::vec2 position, glm::vec2 size, float rotation, glm::vec4 color);
+        void DrawTexture(TextureID texture, glm::vec2 position, glm::vec2 size, float rotation, glm::vec4 color);
+
+        //NOTE: bulk version of DrawTexture, large counts generate their
+        //      vertices on the job system. sprites are not culled one by one
+        void DrawSprites(TextureID texture, const Sprite* sprites, uint32_t count);
+
+        //NOTE: offset is relative to the cursor, the sprite is placed in End.
+        //      with Settings::lateInput the cursor is read again right before
+        //      the last draw
+        void DrawCursorTexture(TextureID texture, glm::vec2 offset, glm::vec2 size, float rotation, glm::vec4 color);
 
         void DrawCircle(glm::vec2 position, float radius, glm::vec4 color);
         void DrawLine(glm::vec2 start, glm::vec2 end, glm::vec4 color);
 
-        uint32_t NumDrawCalls() const { return m_numDrawCalls; }
+        //NOTE: applies to everything drawn after it, reset to ALPHA by every
+        //      Begin. opaque quads (NONE) are held back and drawn front to
+        //      back with blending off before the next blended batch, the
+        //      depth buffer keeps the result in draw order. circles and
+        //      lines are never held back
+        void SetBlendMode(gpu::BlendMode mode) { m_blendMode = mode; }
+
+        //NOTE: primitives entirely outside the camera view are dropped
+        //      before they reach the batch, on by default
+        void SetCulling(bool culling) { m_culling = culling; }
+
+        //NOTE: world space bounds of the current camera view, to query a
+        //      SpatialHash for what is on screen
+        AABB VisibleBounds() const { return { .min = m_viewMin, .max = m_viewMax }; }
+
+        //NOTE: maps window coordinates like Input::MousePosition() to world
+        //      space through the camera of the current Begin, for picking
+        glm::vec2 ScreenToWorld(glm::vec2 screen) const;
+
+        //NOTE: stats of the last completed frame
+        const RendererStats& Stats() const { return m_lastStats; }
+        uint32_t NumDrawCalls() const { return m_lastStats.drawCalls; }
+
+        GpuTimer& GetGpuTimer() { return m_gpuTimer; }
     private:
         struct Vertex {
             glm::vec4 position;
@@ -47,33 +120,107 @@ namespace sal {
             Line,
         };
 
+        // a range of held back opaque quads sharing a texture
+        struct OpaqueRun {
+            TextureID texture;
+            uint32_t  first;
+            uint32_t  count;
+        };
+
+        struct CursorSprite {
+            TextureID texture;
+            Sprite    sprite;
+        };
+
+        static void WriteQuad(Vertex* vertices, const Sprite& sprite, float depth);
+
         void StartBatch();
         void Flush();
+        void FlushOpaque();
+
+        float NextDepth(bool opaque);
+        Vertex* ReserveOpaque(TextureID texture, uint32_t quads);
+
+        void PrepareBatch(BatchMode mode, TextureID texture);
+        void BindShader(uint32_t features);
+        void BindTexture(gpu::TextureHandle texture);
+        void BindState(gpu::BlendMode blend, gpu::DepthTest test, bool depthWrite);
+
+        bool Culled(glm::vec2 min, glm::vec2 max);
 
         bool RequiresFlushForSpace();
         bool RequiresFlushForMode(BatchMode mode);
-        bool RequiresFlushForTexture(Ref<Texture> texture);
+        bool RequiresFlushForTexture(TextureID texture);
+        bool RequiresFlushForBlend(gpu::BlendMode blend);
     private:
-        Camera m_camera = {};
+        Camera      m_camera = {};
+        const char* m_pass   = nullptr;
+
+        bool      m_culling = true;
+        glm::vec2 m_viewMin = {};
+        glm::vec2 m_viewMax = {};
+
+        glm::mat4 m_inverseViewProjection = glm::mat4(1.0f);
+
+        // redundant state tracking, reset at every Begin
+        uint32_t       m_boundShader     = 0;
+        uint32_t       m_boundTexture    = 0;
+        gpu::BlendMode m_boundBlend      = gpu::BlendMode::ALPHA;
+        gpu::DepthTest m_boundDepthTest  = gpu::DepthTest::NONE;
+        bool           m_boundDepthWrite = false;
+
+        // features of the batch shader, see SHADER_FEATURES in the .cpp
+        static constexpr uint32_t SHADER_FEATURE_COUNT = 4;
+        static constexpr uint32_t SHADER_VARIANT_COUNT = 1 << SHADER_FEATURE_COUNT;
+
+        static_assert(SHADER_FEATURE_COUNT <= ShaderVariants::MAX_FEATURES);
 
-        BatchMode    m_batchMode    = BatchMode::None;
-        Ref<Texture> m_batchTexture = {};
+        // camera uniforms are uploaded once per Begin for each shader
+        // variant, indexed by feature mask
+        uint32_t                                   m_cameraVersion  = 0;
+        std::array<uint32_t, SHADER_VARIANT_COUNT> m_uniformVersion = {};
+
+        RendererStats m_stats     = {};
+        RendererStats m_lastStats = {};
+
+        GpuTimer m_gpuTimer = {};
+
+        gpu::BlendMode m_blendMode = gpu::BlendMode::ALPHA;
+
+        BatchMode      m_batchMode    = BatchMode::None;
+        TextureID      m_batchTexture = {};
+        gpu::BlendMode m_batchBlend   = gpu::BlendMode::ALPHA;
+
+        // every primitive gets a depth so opaque quads can be drawn out of
+        // order. it only steps when draws switch between opaque and the
+        // rest, or after the held back quads were drawn
+        uint32_t m_depthLayer   = 0;
+        float    m_depth        = 0.0f;
+        bool     m_layerOpaque  = false;
+        bool     m_layerStarted = false;
+        bool     m_depthInUse   = false; // cleared and written this pass
+
+        std::vector<Vertex>    m_opaqueVertices = {};
+        std::vector<OpaqueRun> m_opaqueRuns     = {};
+        Vertex*                m_opaqueUpload   = nullptr;
+
+        TextureRegistry m_textures = {};
 
         gpu::VertexLayout m_layout       = {};
         Ref<VertexBuffer> m_batchVBO     = {};
         Ref<IndexBuffer>  m_batchIBO     = {};
-        Ref<Texture>      m_whiteTexture = {};
+        TextureID         m_whiteTexture = {};
+
+        ShaderVariants m_shaders = {};
 
-        Ref<Shader> m_quadShader   = {};
-        Ref<Shader> m_circleShader = {};
-        Ref<Shader> m_lineShader   = {};
+        // latched and drawn at End
+        std::vector<CursorSprite> m_cursorSprites = {};
 
         Vertex* m_vertexBufferBase = nullptr;
         Vertex* m_vertexBufferPtr  = nullptr;
 
         uint32_t m_vertexCount = 0;
         uint32_t m_indexCount  = 0;
-        uint32_t m_numDrawCalls = 0;
     };
 }
 
@@ -0,0 +1,34 @@
+#ifndef SAL_GRAPHICS_SHADERVARIANTS_H
+#define SAL_GRAPHICS_SHADERVARIANTS_H
+
+#include "graphics/Shader.h"
+
+#include <unordered_map>
+
+namespace sal {
+    //NOTE: one source with #ifdef'd features, every combination of features
+    //      is compiled on first use and kept by its bitmask. bit i of the
+    //      mask defines features[i] right after the #version line
+    class ShaderVariants {
+    public:
+        static constexpr uint32_t MAX_FEATURES = 8;
+
+        void Init(const char* vertexSource, const char* fragmentSource, std::vector<const char*> features, gpu::VertexLayout layout);
+        void Clear();
+
+        const Ref<Shader>& Get(uint32_t mask);
+
+        uint32_t Count() const { return (uint32_t)m_variants.size(); }
+    private:
+        static std::string AddDefines(const char* source, const std::string& defines);
+    private:
+        const char*              m_vertexSource   = nullptr;
+        const char*              m_fragmentSource = nullptr;
+        std::vector<const char*> m_features       = {};
+        gpu::VertexLayout        m_layout         = {};
+
+        std::unordered_map<uint32_t, Ref<Shader>> m_variants = {};
+    };
+}
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef SAL_GRAPHICS_TEXTUREREGISTRY_H
+#define SAL_GRAPHICS_TEXTUREREGISTRY_H
+
+#include "graphics/Texture.h"
+
+namespace sal {
+    //NOTE: generation 0 is never handed out, so a default constructed
+    //      id is always invalid
+    struct TextureID {
+        uint32_t index      = 0;
+        uint32_t generation = 0;
+
+        bool operator==(const TextureID& other) const = default;
+    };
+
+    class TextureRegistry {
+    public:
+        TextureID Register(Ref<Texture> texture);
+        void Unregister(TextureID id);
+        void Clear();
+
+        bool Valid(TextureID id) const {
+            return id.index < m_slots.size() && m_slots[id.index].generation == id.generation;
+        }
+
+        //NOTE: returns nullptr for stale ids
+        Texture* Get(TextureID id) const {
+            return Valid(id) ? m_slots[id.index].texture.get() : nullptr;
+        }
+    private:
+        struct Slot {
+            Ref<Texture> texture    = {};
+            uint32_t     generation = 1;
+        };
+
+        std::vector<Slot>     m_slots    = {};
+        std::vector<uint32_t> m_freeList = {};
+    };
+}
+
+#endif
@@ -7,6 +7,10 @@ namespace sal::gpu {
     struct ShaderHandle { uint32_t id; };
     struct TextureHandle { uint32_t id; };
     struct BufferHandle { uint32_t id; };
+    struct QueryHandle { uint32_t id; };
+    struct FramebufferHandle { uint32_t id; TextureHandle color; uint32_t depth; };
+
+    using LoadProc = void* (*)(const char* name);
 
     enum class VertexFormat {
         FLOAT,
@@ -20,6 +24,23 @@ namespace sal::gpu {
         TRIANGLE_LIST,
     };
 
+    //NOTE: NONE is opaque, blending off. PREMULTIPLIED expects color
+    //      already multiplied by alpha. MULTIPLY ignores source alpha, the
+    //      shader has to fade color towards white where it is transparent
+    enum class BlendMode {
+        NONE,
+        ALPHA,
+        PREMULTIPLIED,
+        ADDITIVE,
+        MULTIPLY,
+    };
+
+    enum class DepthTest {
+        NONE,
+        LESS,
+        LESS_EQUAL,
+    };
+
     enum class BufferType {
         VERTEX,
         INDEX,
@@ -78,6 +99,17 @@ namespace sal::gpu {
         void*         pixels;
     };
 
+    struct FramebufferDesc {
+        uint32_t width;
+        uint32_t height;
+    };
+
+    struct ProgramCacheStats {
+        uint32_t hits     = 0;
+        uint32_t misses   = 0;
+        uint32_t rejected = 0; // found on disk but refused by the driver
+    };
+
     struct BufferDesc {
         BufferType  type;
         BufferUsage usage;
@@ -85,9 +117,22 @@ namespace sal::gpu {
         void*       data;
     };
 
+    //NOTE: call once the context is current, loads the entry points of
+    //      the optional extensions glad does not know about
+    void init(LoadProc load);
+    bool hasExtension(const char* name);
+
     ShaderHandle createShader(ShaderDesc desc);
     void destroyShader(ShaderHandle shader);
 
+    //NOTE: with a directory set and programBinariesSupported() createShader
+    //      loads linked programs from there, keyed by their sources and the
+    //      driver, and stores what it had to compile. binaries the driver
+    //      rejects after an update are recompiled. null disables the cache
+    void setProgramCacheDirectory(const char* directory);
+    bool programBinariesSupported();
+    ProgramCacheStats programCacheStats();
+
     void setShaderUniform(ShaderHandle shader, const char* name, float value);
     void setShaderUniform(ShaderHandle shader, const char* name, glm::vec2 value);
     void setShaderUniform(ShaderHandle shader, const char* name, glm::vec3 value);
@@ -101,12 +146,36 @@ namespace sal::gpu {
     void destroyBuffer(BufferHandle buffer);
     void setBufferData(BufferType type, BufferHandle, size_t size, void* data);
 
+    //NOTE: rgba color texture and 16 bit depth attachment, id is 0 when
+    //      the driver can not complete it. binding FramebufferHandle{}
+    //      goes back to the default framebuffer
+    FramebufferHandle createFramebuffer(FramebufferDesc desc);
+    void destroyFramebuffer(FramebufferHandle framebuffer);
+
     void bind(ShaderHandle shader);
     void bind(uint32_t unit, TextureHandle texture);
     void bind(BufferType type, BufferHandle buffer);
     void bind(const VertexLayout& layout);
+    void bind(FramebufferHandle framebuffer);
+
+    //NOTE: timer queries need GL_EXT_disjoint_timer_query, everything
+    //      below is a no-op when timerQueriesSupported() is false
+    bool timerQueriesSupported();
+    QueryHandle createTimerQuery();
+    void destroyQuery(QueryHandle query);
+    void beginTimerQuery(QueryHandle query);
+    void endTimerQuery();
+    bool queryResultAvailable(QueryHandle query);
+    uint64_t queryResult(QueryHandle query);
+    bool gpuDisjoint();
 
     void clear(float r, float g, float b, float a);
+    void clearDepth();
+
+    void setBlendMode(BlendMode mode);
+    void setDepthTest(DepthTest test, bool write);
+    void viewport(int x, int y, int width, int height);
+    void finish();
 
     void drawPrimitives(PrimitiveType primitive, uint32_t count);
     void drawPrimitivesIndexed(PrimitiveType primitive, uint32_t count);
@@ -0,0 +1,264 @@
+#include "audio/Adpcm.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace sal
+{
+
+    static constexpr int32_t INDEX_TABLE[16] = {
+        -1, -1, -1, -1, 2, 4, 6, 8,
+        -1, -1, -1, -1, 2, 4, 6, 8,
+    };
+
+    static constexpr int32_t STEP_TABLE[89] = {
+        7, 8, 9, 10, 11, 12, 13, 14, 16, 17,
+        19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+        50, 55, 60, 66, 73, 80, 88, 97, 107, 118,
+        130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+        337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
+        876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+        2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358,
+        5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+        15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767,
+    };
+
+    static constexpr uint32_t HEADER_SIZE = 4;
+
+    // shared by the encoder and decoder so both track the same predictor
+    static void Step(int32_t code, int32_t& predictor, int32_t& index)
+    {
+        int32_t step  = STEP_TABLE[index];
+        int32_t delta = step >> 3;
+
+        if (code & 4) delta += step;
+        if (code & 2) delta += step >> 1;
+        if (code & 1) delta += step >> 2;
+
+        predictor = std::clamp(code & 8 ? predictor - delta : predictor + delta, -32768, 32767);
+        index     = std::clamp(index + INDEX_TABLE[code], 0, 88);
+    }
+
+    static int32_t Encode(int32_t sample, int32_t& predictor, int32_t& index)
+    {
+        int32_t step = STEP_TABLE[index];
+        int32_t diff = sample - predictor;
+        int32_t code = 0;
+
+        if (diff < 0)
+        {
+            code = 8;
+            diff = -diff;
+        }
+
+        if (diff >= step)        { code |= 4; diff -= step; }
+        if (diff >= step >> 1)   { code |= 2; diff -= step >> 1; }
+        if (diff >= step >> 2)   { code |= 1; }
+
+        Step(code, predictor, index);
+        return code;
+    }
+
+    size_t AdpcmBlockSize(uint32_t channels)
+    {
+        return channels * HEADER_SIZE + ((ADPCM_BLOCK_FRAMES - 1) * channels + 1) / 2;
+    }
+
+    size_t AdpcmSize(uint64_t frameCount, uint32_t channels)
+    {
+        uint64_t blocks = (frameCount + ADPCM_BLOCK_FRAMES - 1) / ADPCM_BLOCK_FRAMES;
+        return blocks * AdpcmBlockSize(channels);
+    }
+
+    void AdpcmEncode(const int16_t* pcm, uint64_t frameCount, uint32_t channels, uint8_t* output)
+    {
+        ASSERT(channels <= ADPCM_MAX_CHANNELS);
+
+        size_t blockSize = AdpcmBlockSize(channels);
+
+        // the tail of the last block is zero padding
+        std::memset(output, 0, AdpcmSize(frameCount, channels));
+
+        for (uint64_t start = 0; start < frameCount; start += ADPCM_BLOCK_FRAMES)
+        {
+            uint8_t*       block  = output + (start / ADPCM_BLOCK_FRAMES) * blockSize;
+            uint8_t*       codes  = block + channels * HEADER_SIZE;
+            const int16_t* frames = pcm + start * channels;
+
+            uint64_t count = std::min<uint64_t>(ADPCM_BLOCK_FRAMES, frameCount - start);
+
+            std::array<int32_t, ADPCM_MAX_CHANNELS> predictor = {};
+            std::array<int32_t, ADPCM_MAX_CHANNELS> index     = {};
+
+            for (uint32_t c = 0; c < channels; c++)
+            {
+                predictor[c] = frames[c];
+
+                // start from a step that roughly fits the first difference
+                int32_t diff = count > 1 ? std::abs(frames[channels + c] - frames[c]) : 0;
+
+                while (index[c] < 88 && STEP_TABLE[index[c]] < diff)
+                {
+                    index[c]++;
+                }
+
+                int16_t first = (int16_t)predictor[c];
+                std::memcpy(block + c * HEADER_SIZE, &first, sizeof(first));
+                block[c * HEADER_SIZE + 2] = (uint8_t)index[c];
+            }
+
+            for (uint64_t f = 1; f < count; f++)
+            {
+                for (uint32_t c = 0; c < channels; c++)
+                {
+                    size_t  nibble = (f - 1) * channels + c;
+                    int32_t code   = Encode(frames[f * channels + c], predictor[c], index[c]);
+
+                    codes[nibble / 2] |= (uint8_t)(nibble & 1 ? code << 4 : code);
+                }
+            }
+        }
+    }
+
+    ma_data_source_vtable AdpcmSource::s_vtable = {
+        AdpcmSource::OnRead,
+        AdpcmSource::OnSeek,
+        AdpcmSource::OnGetDataFormat,
+        AdpcmSource::OnGetCursor,
+        AdpcmSource::OnGetLength,
+        NULL, // looping is done by the data source base through OnSeek
+        0,
+    };
+
+    ma_result AdpcmSource::Init(const void* data, uint64_t frameCount, uint32_t channels, uint32_t sampleRate)
+    {
+        if (channels == 0 || channels > ADPCM_MAX_CHANNELS)
+        {
+            return MA_INVALID_ARGS;
+        }
+
+        ma_data_source_config config = ma_data_source_config_init();
+        config.vtable = &s_vtable;
+
+        ma_result result = ma_data_source_init(&config, &m_base);
+
+        if (result != MA_SUCCESS)
+        {
+            return result;
+        }
+
+        m_data       = (const uint8_t*)data;
+        m_frameCount = frameCount;
+        m_channels   = channels;
+        m_sampleRate = sampleRate;
+        m_blockSize  = AdpcmBlockSize(channels);
+        m_cursor     = 0;
+
+        return MA_SUCCESS;
+    }
+
+    void AdpcmSource::Uninit()
+    {
+        ma_data_source_uninit(&m_base);
+    }
+
+    void AdpcmSource::DecodeFrame(int16_t* output)
+    {
+        uint32_t       offset = (uint32_t)(m_cursor % ADPCM_BLOCK_FRAMES);
+        const uint8_t* block  = m_data + (m_cursor / ADPCM_BLOCK_FRAMES) * m_blockSize;
+
+        if (offset == 0)
+        {
+            for (uint32_t c = 0; c < m_channels; c++)
+            {
+                int16_t first = 0;
+                std::memcpy(&first, block + c * HEADER_SIZE, sizeof(first));
+
+                m_predictor[c] = first;
+                m_index[c]     = std::min<int32_t>(block[c * HEADER_SIZE + 2], 88);
+            }
+        }
+        else
+        {
+            const uint8_t* codes = block + m_channels * HEADER_SIZE;
+
+            for (uint32_t c = 0; c < m_channels; c++)
+            {
+                size_t  nibble = (size_t)(offset - 1) * m_channels + c;
+                int32_t code   = nibble & 1 ? codes[nibble / 2] >> 4 : codes[nibble / 2] & 0xf;
+
+                Step(code, m_predictor[c], m_index[c]);
+            }
+        }
+
+        if (output)
+        {
+            for (uint32_t c = 0; c < m_channels; c++)
+            {
+                output[c] = (int16_t)m_predictor[c];
+            }
+        }
+
+        m_cursor++;
+    }
+
+    ma_result AdpcmSource::OnRead(ma_data_source* source, void* output, ma_uint64 frameCount, ma_uint64* framesRead)
+    {
+        AdpcmSource& adpcm  = *(AdpcmSource*)source;
+        int16_t*     frames = (int16_t*)output;
+
+        uint64_t count = std::min<uint64_t>(frameCount, adpcm.m_frameCount - adpcm.m_cursor);
+
+        for (uint64_t i = 0; i < count; i++)
+        {
+            adpcm.DecodeFrame(frames + i * adpcm.m_channels);
+        }
+
+        *framesRead = count;
+        return count == 0 ? MA_AT_END : MA_SUCCESS;
+    }
+
+    ma_result AdpcmSource::OnSeek(ma_data_source* source, ma_uint64 frame)
+    {
+        AdpcmSource& adpcm = *(AdpcmSource*)source;
+
+        if (frame > adpcm.m_frameCount)
+        {
+            return MA_INVALID_ARGS;
+        }
+
+        // restart at the block header and decode up to the frame
+        adpcm.m_cursor = frame - frame % ADPCM_BLOCK_FRAMES;
+
+        while (adpcm.m_cursor < frame)
+        {
+            adpcm.DecodeFrame(nullptr);
+        }
+
+        return MA_SUCCESS;
+    }
+
+    ma_result AdpcmSource::OnGetDataFormat(ma_data_source* source, ma_format* format, ma_uint32* channels, ma_uint32* sampleRate, ma_channel* channelMap, size_t channelMapCap)
+    {
+        AdpcmSource& adpcm = *(AdpcmSource*)source;
+
+        *format     = ma_format_s16;
+        *channels   = adpcm.m_channels;
+        *sampleRate = adpcm.m_sampleRate;
+
+        return MA_SUCCESS;
+    }
+
+    ma_result AdpcmSource::OnGetCursor(ma_data_source* source, ma_uint64* cursor)
+    {
+        *cursor = ((AdpcmSource*)source)->m_cursor;
+        return MA_SUCCESS;
+    }
+
+    ma_result AdpcmSource::OnGetLength(ma_data_source* source, ma_uint64* length)
+    {
+        *length = ((AdpcmSource*)source)->m_frameCount;
+        return MA_SUCCESS;
+    }
+
+}
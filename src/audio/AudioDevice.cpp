@@ -1,20 +1,66 @@
 #include "audio/AudioDevice.h"
+#include "audio/Music.h"
 #include "audio/Sound.h"
+#include "core/Profiler.h"
+#include "graphics/Camera.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <utility>
 
 namespace sal
 {
 
-    void AudioDevice::Init()
+    static float GetAttenuation(const Attenuation& attenuation, float distance)
+    {
+        float minDistance = std::max(attenuation.minDistance, 0.001f);
+
+        if (distance <= minDistance)
+        {
+            return 1.0f;
+        }
+
+        switch (attenuation.curve)
+        {
+            case AttenuationCurve::NONE: return 1.0f;
+            case AttenuationCurve::LINEAR: return std::clamp(1.0f - (distance - minDistance) / (attenuation.maxDistance - minDistance), 0.0f, 1.0f);
+            case AttenuationCurve::INVERSE: return minDistance / (minDistance + attenuation.rolloff * (distance - minDistance));
+            case AttenuationCurve::EXPONENTIAL: return std::pow(distance / minDistance, -attenuation.rolloff);
+        }
+
+        return 1.0f;
+    }
+
+    static ma_format GetMAAudioFormat(EAudioFormat format)
+    {
+        switch (format)
+        {
+            case EAudioFormat::U8: return ma_format_u8;
+            case EAudioFormat::S16: return ma_format_s16;
+            case EAudioFormat::S24: return ma_format_s24;
+            case EAudioFormat::S32: return ma_format_s32;
+            case EAudioFormat::F32: return ma_format_f32;
+        }
+
+        ASSERT(false);
+        return ma_format_unknown;
+    }
+
+    void AudioDevice::Init(const AudioSettings& settings)
     {
         ma_result result = {};
 
-        ma_backend backends[] = {
-            ma_backend_wasapi,
-            ma_backend_alsa,
-            ma_backend_null,
-        };
+        ma_backend nullBackend = ma_backend_null;
 
-        result = ma_context_init(backends, 3, NULL, &m_context);
+        if (settings.nullBackend)
+        {
+            result = ma_context_init(&nullBackend, 1, NULL, &m_context);
+        }
+        else
+        {
+            result = ma_context_init(settings.backends.empty() ? NULL : settings.backends.data(), (ma_uint32)settings.backends.size(), NULL, &m_context);
+        }
 
         if (result != MA_SUCCESS)
         {
@@ -22,20 +68,652 @@ namespace sal
             std::exit(-1);
         }
 
-        result = ma_engine_init(NULL, &m_engine);
+        // the device is ours instead of the engine's so the callback can be timed
+        ma_device_config deviceConfig    = ma_device_config_init(ma_device_type_playback);
+        deviceConfig.playback.format     = ma_format_f32;
+        deviceConfig.playback.channels   = settings.channels;
+        deviceConfig.sampleRate          = settings.sampleRate;
+        deviceConfig.periodSizeInFrames  = settings.periodSizeInFrames;
+        deviceConfig.periods             = settings.periods;
+        deviceConfig.performanceProfile  = settings.latency == AudioLatency::LOW ? ma_performance_profile_low_latency : ma_performance_profile_conservative;
+        deviceConfig.dataCallback        = DataCallback;
+        deviceConfig.pUserData           = this;
+
+        result = ma_device_init(&m_context, &deviceConfig, &m_device);
+
+        if (result != MA_SUCCESS)
+        {
+            std::cout << "MA device init failed" << std::endl;
+            std::exit(-1);
+        }
+
+        ma_engine_config engineConfig = ma_engine_config_init();
+        engineConfig.pContext         = &m_context;
+        engineConfig.pDevice          = &m_device;
+
+        result = ma_engine_init(&engineConfig, &m_engine);
 
         if (result != MA_SUCCESS)
         {
             std::cout << "MA engine init failed" << std::endl;
             std::exit(-1);
         }
+
+        m_streaming    = true;
+        m_streamThread = std::thread(&AudioDevice::StreamLoop, this);
     }
 
     void AudioDevice::Shutdown()
     {
+        {
+            std::lock_guard<std::mutex> lock(m_streamMutex);
+            m_streaming = false;
+        }
+
+        m_streamWake.notify_all();
+        m_streamThread.join();
+
+        for (Voice& voice : m_voices)
+        {
+            ReleaseVoice(voice);
+        }
+
+        // buses can be reparented in any order, so cut every connection
+        // before the first one goes away
+        for (const Scope<MixerBus>& bus : m_buses)
+        {
+            bus->Detach();
+        }
+
+        for (const Scope<MixerBus>& bus : m_buses)
+        {
+            bus->Uninit();
+        }
+
+        m_buses.clear();
+
         ma_engine_stop(&m_engine);
         ma_engine_uninit(&m_engine);
+        ma_device_uninit(&m_device);
         ma_context_uninit(&m_context);
     }
 
-}
\ No newline at end of file
+    void AudioDevice::NewFrame(float delta)
+    {
+        m_newVoices = 0;
+
+        for (Voice& voice : m_voices)
+        {
+            if (!voice.initialized)
+            {
+                continue;
+            }
+
+            if (voice.virtualized)
+            {
+                AdvanceVirtual(voice, delta);
+            }
+
+            if (voice.initialized && voice.spatial)
+            {
+                Spatialize(voice);
+            }
+        }
+
+        m_activeVoices  = ActiveVoices();
+        m_virtualVoices = VirtualVoices();
+        m_peakVoices    = std::max(m_peakVoices, m_activeVoices);
+    }
+
+    void AudioDevice::SetListener(const Camera& camera)
+    {
+        glm::vec4 center = glm::inverse(camera.ProjectionMatrix() * camera.ViewMatrix()) * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+        m_listener       = glm::vec2(center);
+    }
+
+    VoiceHandle AudioDevice::Play(Sound& sound, const PlayParams& params)
+    {
+        if (m_newVoices >= m_newVoicesPerFrame)
+        {
+            return {};
+        }
+
+        Voice* voice = AcquireVoice(params.priority);
+
+        if (!voice)
+        {
+            return {};
+        }
+
+        const SoundDesc& desc = sound.Desc();
+
+        // only the cursor is per voice, the pcm itself is never copied
+        ma_result result = MA_SUCCESS;
+
+        if (desc.format == EAudioFormat::IMA_ADPCM)
+        {
+            result        = voice->adpcm.Init(desc.data, desc.frameCount, desc.channels, desc.sampleRate);
+            voice->source = &voice->adpcm;
+        }
+        else
+        {
+            result                   = ma_audio_buffer_ref_init(GetMAAudioFormat(desc.format), desc.channels, desc.data, desc.frameCount, &voice->buffer);
+            voice->buffer.sampleRate = desc.sampleRate;
+            voice->source            = &voice->buffer;
+        }
+
+        if (result != MA_SUCCESS)
+        {
+            voice->source = nullptr;
+            return {};
+        }
+
+        ma_sound_group* group = params.bus ? params.bus->Group() : NULL;
+
+        result = ma_sound_init_from_data_source(&m_engine, voice->source, MA_SOUND_FLAG_NO_SPATIALIZATION, group, &voice->sound);
+
+        if (result != MA_SUCCESS)
+        {
+            ReleaseSource(*voice);
+            return {};
+        }
+
+        voice->initialized = true;
+        voice->owner       = &sound;
+        voice->bus         = params.bus;
+        voice->priority    = params.priority;
+        voice->started     = m_playCount++;
+        voice->volume      = params.volume;
+        voice->pan         = params.pan;
+        voice->pitch       = params.pitch;
+        voice->looping     = params.looping;
+        voice->spatial     = params.spatial;
+        voice->position    = params.position;
+        voice->attenuation = params.attenuation;
+        voice->virtualized = false;
+        voice->cursor      = 0.0;
+
+        ma_sound_set_volume(&voice->sound, params.volume);
+        ma_sound_set_pan(&voice->sound, params.pan);
+        ma_sound_set_pitch(&voice->sound, params.pitch);
+        ma_sound_set_looping(&voice->sound, params.looping);
+
+        // inaudible spatial voices start out virtual and never reach the mixer
+        if (voice->spatial)
+        {
+            voice->virtualized = true;
+            Spatialize(*voice);
+        }
+        else
+        {
+            ma_sound_start(&voice->sound);
+        }
+
+        m_newVoices++;
+
+        return { .index = (uint32_t)(voice - m_voices.data()), .generation = voice->generation };
+    }
+
+    void AudioDevice::Stop(VoiceHandle handle)
+    {
+        if (Voice* voice = GetVoice(handle))
+        {
+            ReleaseVoice(*voice);
+        }
+    }
+
+    bool AudioDevice::Playing(VoiceHandle handle) const
+    {
+        const Voice* voice = GetVoice(handle);
+        return voice && InUse(*voice);
+    }
+
+    void AudioDevice::SetVolume(VoiceHandle handle, float volume)
+    {
+        if (Voice* voice = GetVoice(handle))
+        {
+            voice->volume = volume;
+
+            if (voice->spatial)
+            {
+                Spatialize(*voice);
+            }
+            else
+            {
+                ma_sound_set_volume(&voice->sound, volume);
+            }
+        }
+    }
+
+    void AudioDevice::SetPan(VoiceHandle handle, float pan)
+    {
+        if (Voice* voice = GetVoice(handle))
+        {
+            voice->pan = pan;
+
+            if (voice->spatial)
+            {
+                Spatialize(*voice);
+            }
+            else
+            {
+                ma_sound_set_pan(&voice->sound, pan);
+            }
+        }
+    }
+
+    void AudioDevice::SetPitch(VoiceHandle handle, float pitch)
+    {
+        if (Voice* voice = GetVoice(handle))
+        {
+            voice->pitch = pitch;
+            ma_sound_set_pitch(&voice->sound, pitch);
+        }
+    }
+
+    void AudioDevice::SetPosition(VoiceHandle handle, glm::vec2 position)
+    {
+        if (Voice* voice = GetVoice(handle))
+        {
+            voice->position = position;
+        }
+    }
+
+    uint32_t AudioDevice::ActiveVoices() const
+    {
+        uint32_t count = 0;
+
+        for (const Voice& voice : m_voices)
+        {
+            if (voice.initialized && !voice.virtualized && ma_sound_is_playing(&voice.sound))
+            {
+                count++;
+            }
+        }
+
+        return count;
+    }
+
+    uint32_t AudioDevice::VirtualVoices() const
+    {
+        uint32_t count = 0;
+
+        for (const Voice& voice : m_voices)
+        {
+            if (voice.initialized && voice.virtualized)
+            {
+                count++;
+            }
+        }
+
+        return count;
+    }
+
+    MixerBus* AudioDevice::CreateBus(MixerBus* parent)
+    {
+        Scope<MixerBus> bus(new MixerBus(*this));
+
+        if (!bus->Init(parent))
+        {
+            std::cout << "MA mixer bus init failed" << std::endl;
+            bus->Uninit();
+            return nullptr;
+        }
+
+        return m_buses.emplace_back(std::move(bus)).get();
+    }
+
+    void AudioDevice::DestroyBus(MixerBus* bus)
+    {
+        auto it = std::find_if(m_buses.begin(), m_buses.end(), [bus](const Scope<MixerBus>& other) { return other.get() == bus; });
+
+        if (it == m_buses.end())
+        {
+            return;
+        }
+
+        for (Voice& voice : m_voices)
+        {
+            if (voice.bus == bus)
+            {
+                ReleaseVoice(voice);
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_streamMutex);
+
+            for (Music* music : m_streams)
+            {
+                if (music->Bus() == bus)
+                {
+                    music->SetBus(nullptr);
+                }
+            }
+        }
+
+        for (const Scope<MixerBus>& other : m_buses)
+        {
+            if (other->Parent() == bus)
+            {
+                other->SetParent(nullptr);
+            }
+        }
+
+        bus->Uninit();
+        m_buses.erase(it);
+    }
+
+    void AudioDevice::StartOutput()
+    {
+        ma_engine_start(&m_engine);
+    }
+
+    void AudioDevice::StopOutput()
+    {
+        ma_engine_stop(&m_engine);
+    }
+
+    void AudioDevice::Mix(float* output, uint32_t frameCount)
+    {
+        Render(output, frameCount);
+    }
+
+    AudioStats AudioDevice::GetStats() const
+    {
+        AudioStats stats = {};
+
+        stats.callbacks     = m_callbacks.load(std::memory_order_relaxed);
+        stats.slowMixes     = m_slowMixes.load(std::memory_order_relaxed);
+        stats.lateCallbacks = m_lateCallbacks.load(std::memory_order_relaxed);
+        stats.lastMixMs     = m_lastMixMs.load(std::memory_order_relaxed);
+        stats.averageMixMs  = m_averageMixMs.load(std::memory_order_relaxed);
+        stats.peakMixMs     = m_peakMixMs.load(std::memory_order_relaxed);
+        stats.load          = m_load.load(std::memory_order_relaxed);
+        stats.peakLoad      = m_peakLoad.load(std::memory_order_relaxed);
+        stats.activeVoices  = m_activeVoices;
+        stats.virtualVoices = m_virtualVoices;
+        stats.peakVoices    = m_peakVoices;
+        stats.periodFrames  = m_device.playback.internalPeriodSizeInFrames;
+        stats.sampleRate    = m_device.sampleRate;
+
+        stats.streamUnderruns = m_streamUnderruns.load(std::memory_order_relaxed);
+
+        return stats;
+    }
+
+    void AudioDevice::ResetPeaks()
+    {
+        m_peakVoices = m_activeVoices;
+        m_resetPeaks.store(true, std::memory_order_relaxed);
+    }
+
+    void AudioDevice::DataCallback(ma_device* device, void* output, const void* input, ma_uint32 frameCount)
+    {
+        AudioDevice& audio = *(AudioDevice*)device->pUserData;
+
+        int64_t now = std::chrono::steady_clock::now().time_since_epoch().count();
+
+        if (audio.m_lastCallback != 0)
+        {
+            double gap    = std::chrono::duration<double>(std::chrono::steady_clock::duration(now - audio.m_lastCallback)).count();
+            double period = (double)device->playback.internalPeriodSizeInFrames / (double)device->sampleRate;
+
+            if (gap > period * LATE_PERIODS)
+            {
+                audio.m_lateCallbacks.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        audio.m_lastCallback = now;
+        audio.Render((float*)output, frameCount);
+    }
+
+    void AudioDevice::Render(float* output, uint32_t frameCount)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        Clock::time_point start = Clock::now();
+        ma_engine_read_pcm_frames(&m_engine, output, frameCount, NULL);
+        float mixMs = std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+
+        float bufferMs = 1000.0f * (float)frameCount / (float)ma_engine_get_sample_rate(&m_engine);
+        float load     = mixMs / bufferMs;
+
+        if (load > 1.0f)
+        {
+            m_slowMixes.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        if (m_resetPeaks.exchange(false, std::memory_order_relaxed))
+        {
+            m_peakMixMs.store(0.0f, std::memory_order_relaxed);
+            m_peakLoad.store(0.0f, std::memory_order_relaxed);
+        }
+
+        // the only writer is this thread, plain loads and stores are enough
+        float average = m_averageMixMs.load(std::memory_order_relaxed);
+        average       = m_callbacks.load(std::memory_order_relaxed) == 0 ? mixMs : average + (mixMs - average) * 0.05f;
+
+        m_lastMixMs.store(mixMs, std::memory_order_relaxed);
+        m_averageMixMs.store(average, std::memory_order_relaxed);
+        m_peakMixMs.store(std::max(m_peakMixMs.load(std::memory_order_relaxed), mixMs), std::memory_order_relaxed);
+        m_load.store(load, std::memory_order_relaxed);
+        m_peakLoad.store(std::max(m_peakLoad.load(std::memory_order_relaxed), load), std::memory_order_relaxed);
+        m_callbacks.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    AudioDevice::Voice* AudioDevice::GetVoice(VoiceHandle handle)
+    {
+        return const_cast<Voice*>(std::as_const(*this).GetVoice(handle));
+    }
+
+    const AudioDevice::Voice* AudioDevice::GetVoice(VoiceHandle handle) const
+    {
+        if (handle.index >= MAX_VOICES)
+        {
+            return nullptr;
+        }
+
+        const Voice& voice = m_voices[handle.index];
+
+        if (!voice.initialized || voice.generation != handle.generation)
+        {
+            return nullptr;
+        }
+
+        return &voice;
+    }
+
+    AudioDevice::Voice* AudioDevice::AcquireVoice(int priority)
+    {
+        Voice* victim = nullptr;
+
+        for (Voice& voice : m_voices)
+        {
+            // finished voices are free, they just were not cleaned up yet
+            if (!InUse(voice))
+            {
+                ReleaseVoice(voice);
+                return &voice;
+            }
+
+            // steal the lowest priority, inaudible voices first and then the oldest
+            if (!victim || voice.priority < victim->priority || (voice.priority == victim->priority && (voice.virtualized > victim->virtualized || (voice.virtualized == victim->virtualized && voice.started < victim->started))))
+            {
+                victim = &voice;
+            }
+        }
+
+        if (victim->priority > priority)
+        {
+            return nullptr;
+        }
+
+        ReleaseVoice(*victim);
+        return victim;
+    }
+
+    bool AudioDevice::InUse(const Voice& voice) const
+    {
+        return voice.initialized && (voice.virtualized || ma_sound_is_playing(&voice.sound));
+    }
+
+    void AudioDevice::Spatialize(Voice& voice)
+    {
+        glm::vec2 offset   = voice.position - m_listener;
+        float     distance = glm::length(offset);
+        float     gain     = voice.volume * GetAttenuation(voice.attenuation, distance);
+        float     pan      = std::clamp(voice.pan + offset.x / m_panDistance, -1.0f, 1.0f);
+
+        bool audible = distance < voice.attenuation.maxDistance && gain > AUDIBLE_GAIN;
+
+        ma_sound_set_volume(&voice.sound, gain);
+        ma_sound_set_pan(&voice.sound, pan);
+
+        if (audible && voice.virtualized)
+        {
+            voice.virtualized = false;
+
+            ma_sound_seek_to_pcm_frame(&voice.sound, (ma_uint64)voice.cursor);
+            ma_sound_start(&voice.sound);
+        }
+        else if (!audible && !voice.virtualized && ma_sound_is_playing(&voice.sound))
+        {
+            ma_uint64 cursor = 0;
+            ma_sound_get_cursor_in_pcm_frames(&voice.sound, &cursor);
+
+            voice.virtualized = true;
+            voice.cursor      = (double)cursor;
+
+            ma_sound_stop(&voice.sound);
+        }
+    }
+
+    void AudioDevice::AdvanceVirtual(Voice& voice, float delta)
+    {
+        const SoundDesc& desc = voice.owner->Desc();
+
+        voice.cursor += (double)delta * voice.pitch * desc.sampleRate;
+
+        if (voice.cursor < (double)desc.frameCount)
+        {
+            return;
+        }
+
+        // a one shot that would have finished by now is simply done
+        if (!voice.looping || desc.frameCount == 0)
+        {
+            ReleaseVoice(voice);
+            return;
+        }
+
+        voice.cursor = std::fmod(voice.cursor, (double)desc.frameCount);
+    }
+
+    void AudioDevice::ReleaseVoice(Voice& voice)
+    {
+        if (!voice.initialized)
+        {
+            return;
+        }
+
+        ma_sound_uninit(&voice.sound);
+        ReleaseSource(voice);
+
+        voice.initialized = false;
+        voice.virtualized = false;
+        voice.owner       = nullptr;
+        voice.bus         = nullptr;
+
+        // skip 0 on wrap around so stale handles never match again
+        voice.generation++;
+
+        if (voice.generation == 0)
+        {
+            voice.generation = 1;
+        }
+    }
+
+    void AudioDevice::ReleaseSource(Voice& voice)
+    {
+        if (voice.source == &voice.adpcm)
+        {
+            voice.adpcm.Uninit();
+        }
+        else if (voice.source == &voice.buffer)
+        {
+            ma_audio_buffer_ref_uninit(&voice.buffer);
+        }
+
+        voice.source = nullptr;
+    }
+
+    void AudioDevice::StopVoices(const Sound& sound)
+    {
+        for (Voice& voice : m_voices)
+        {
+            if (voice.owner == &sound)
+            {
+                ReleaseVoice(voice);
+            }
+        }
+    }
+
+    void AudioDevice::AddStream(Music* music)
+    {
+        std::lock_guard<std::mutex> lock(m_streamMutex);
+        m_streams.push_back(music);
+    }
+
+    void AudioDevice::RemoveStream(Music* music)
+    {
+        std::unique_lock<std::mutex> lock(m_streamMutex);
+        m_streams.erase(std::remove(m_streams.begin(), m_streams.end(), music), m_streams.end());
+
+        // only waits if this very music is being decoded, once this returns
+        // the streaming thread can no longer touch it
+        m_refillDone.wait(lock, [this, music] { return m_refilling != music; });
+    }
+
+    void AudioDevice::WakeStreams()
+    {
+        // called from the audio thread, so no lock. a missed wake up only
+        // delays the refill until the next interval
+        m_streamWake.notify_one();
+    }
+
+    void AudioDevice::StreamLoop()
+    {
+        SAL_PROFILE_THREAD("Audio Streaming");
+
+        std::vector<Music*>          streams = {};
+        std::unique_lock<std::mutex> lock(m_streamMutex);
+
+        while (m_streaming)
+        {
+            streams = m_streams;
+
+            for (Music* music : streams)
+            {
+                // removed while an earlier one was decoding
+                if (std::find(m_streams.begin(), m_streams.end(), music) == m_streams.end())
+                {
+                    continue;
+                }
+
+                m_refilling = music;
+                lock.unlock();
+
+                music->Refill();
+
+                lock.lock();
+                m_refilling = nullptr;
+                m_refillDone.notify_all();
+            }
+
+            m_streamWake.wait_for(lock, std::chrono::milliseconds(STREAM_INTERVAL_MS));
+        }
+    }
+
+}
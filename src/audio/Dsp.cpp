@@ -0,0 +1,256 @@
+#include "audio/Dsp.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(SAL_DSP_SSE2)
+    #include <emmintrin.h>
+#elif defined(SAL_DSP_NEON)
+    #include <arm_neon.h>
+#endif
+
+namespace sal::dsp
+{
+
+#if defined(SAL_DSP_SSE2)
+    using f32x4 = __m128;
+
+    static inline f32x4 load(const float* p) { return _mm_loadu_ps(p); }
+    static inline void store(float* p, f32x4 v) { _mm_storeu_ps(p, v); }
+    static inline f32x4 splat(float x) { return _mm_set1_ps(x); }
+    static inline f32x4 set(float a, float b, float c, float d) { return _mm_setr_ps(a, b, c, d); }
+    static inline f32x4 add(f32x4 a, f32x4 b) { return _mm_add_ps(a, b); }
+    static inline f32x4 mul(f32x4 a, f32x4 b) { return _mm_mul_ps(a, b); }
+    static inline f32x4 max(f32x4 a, f32x4 b) { return _mm_max_ps(a, b); }
+    static inline f32x4 abs(f32x4 a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+
+    template<int LANE>
+    static inline f32x4 broadcast(f32x4 v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(LANE, LANE, LANE, LANE)); }
+
+    static inline float horizontalMax(f32x4 v)
+    {
+        v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+        v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+        return _mm_cvtss_f32(v);
+    }
+
+    // 4 interleaved stereo frames to one vector per channel and back
+    static inline void loadStereo(const float* p, f32x4& left, f32x4& right)
+    {
+        f32x4 a = _mm_loadu_ps(p);
+        f32x4 b = _mm_loadu_ps(p + 4);
+
+        left  = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        right = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+    }
+
+    static inline void storeStereo(float* p, f32x4 left, f32x4 right)
+    {
+        _mm_storeu_ps(p, _mm_unpacklo_ps(left, right));
+        _mm_storeu_ps(p + 4, _mm_unpackhi_ps(left, right));
+    }
+#elif defined(SAL_DSP_NEON)
+    using f32x4 = float32x4_t;
+
+    static inline f32x4 load(const float* p) { return vld1q_f32(p); }
+    static inline void store(float* p, f32x4 v) { vst1q_f32(p, v); }
+    static inline f32x4 splat(float x) { return vdupq_n_f32(x); }
+    static inline f32x4 set(float a, float b, float c, float d) { float v[4] = { a, b, c, d }; return vld1q_f32(v); }
+    static inline f32x4 add(f32x4 a, f32x4 b) { return vaddq_f32(a, b); }
+    static inline f32x4 mul(f32x4 a, f32x4 b) { return vmulq_f32(a, b); }
+    static inline f32x4 max(f32x4 a, f32x4 b) { return vmaxq_f32(a, b); }
+    static inline f32x4 abs(f32x4 a) { return vabsq_f32(a); }
+
+    template<int LANE>
+    static inline f32x4 broadcast(f32x4 v) { return vdupq_n_f32(vgetq_lane_f32(v, LANE)); }
+
+    static inline float horizontalMax(f32x4 v)
+    {
+        float32x2_t pair = vpmax_f32(vget_low_f32(v), vget_high_f32(v));
+        return vget_lane_f32(vpmax_f32(pair, pair), 0);
+    }
+
+    static inline void loadStereo(const float* p, f32x4& left, f32x4& right)
+    {
+        float32x4x2_t frames = vld2q_f32(p);
+
+        left  = frames.val[0];
+        right = frames.val[1];
+    }
+
+    static inline void storeStereo(float* p, f32x4 left, f32x4 right)
+    {
+        float32x4x2_t frames = { { left, right } };
+        vst2q_f32(p, frames);
+    }
+#endif
+
+#if defined(SAL_DSP_SSE2) || defined(SAL_DSP_NEON)
+    // y[n] = b * y[n - 1] + a * x[n] expanded over four frames, every output
+    // only depends on the previous block's last output instead of its neighbour
+    static inline f32x4 lowPass4(f32x4 x, f32x4 previous, const f32x4* weights)
+    {
+        f32x4 y = mul(previous, weights[0]);
+
+        y = add(y, mul(broadcast<0>(x), weights[1]));
+        y = add(y, mul(broadcast<1>(x), weights[2]));
+        y = add(y, mul(broadcast<2>(x), weights[3]));
+        y = add(y, mul(broadcast<3>(x), weights[4]));
+
+        return y;
+    }
+#endif
+
+    void lowPass(float* samples, uint32_t frameCount, uint32_t channels, float coefficient, float* state)
+    {
+        float a = coefficient;
+        float b = 1.0f - coefficient;
+
+        uint32_t frame = 0;
+
+#if defined(SAL_DSP_SSE2) || defined(SAL_DSP_NEON)
+        if (channels <= 2)
+        {
+            float b2 = b * b;
+            float b3 = b2 * b;
+
+            const f32x4 weights[5] = {
+                set(b, b2, b3, b3 * b),
+                set(a, a * b, a * b2, a * b3),
+                set(0.0f, a, a * b, a * b2),
+                set(0.0f, 0.0f, a, a * b),
+                set(0.0f, 0.0f, 0.0f, a),
+            };
+
+            if (channels == 1)
+            {
+                f32x4 previous = splat(state[0]);
+
+                for (; frame + 4 <= frameCount; frame += 4)
+                {
+                    f32x4 y = lowPass4(load(samples + frame), previous, weights);
+                    store(samples + frame, y);
+                    previous = broadcast<3>(y);
+                }
+
+                float last[4];
+                store(last, previous);
+
+                state[0] = last[0];
+            }
+            else
+            {
+                f32x4 previousLeft  = splat(state[0]);
+                f32x4 previousRight = splat(state[1]);
+
+                for (; frame + 4 <= frameCount; frame += 4)
+                {
+                    f32x4 left, right;
+                    loadStereo(samples + frame * 2, left, right);
+
+                    left  = lowPass4(left, previousLeft, weights);
+                    right = lowPass4(right, previousRight, weights);
+
+                    storeStereo(samples + frame * 2, left, right);
+
+                    previousLeft  = broadcast<3>(left);
+                    previousRight = broadcast<3>(right);
+                }
+
+                float lastLeft[4];
+                float lastRight[4];
+
+                store(lastLeft, previousLeft);
+                store(lastRight, previousRight);
+
+                state[0] = lastLeft[0];
+                state[1] = lastRight[0];
+            }
+        }
+#endif
+
+        for (; frame < frameCount; frame++)
+        {
+            for (uint32_t c = 0; c < channels; c++)
+            {
+                float& sample = samples[frame * channels + c];
+
+                state[c] = b * state[c] + a * sample;
+                sample   = state[c];
+            }
+        }
+    }
+
+    float lowPassCoefficient(float cutoff, uint32_t sampleRate)
+    {
+        if (cutoff <= 0.0f || sampleRate == 0)
+        {
+            return 1.0f;
+        }
+
+        return 1.0f - std::exp(-2.0f * 3.14159265f * cutoff / (float)sampleRate);
+    }
+
+    float peak(const float* samples, uint32_t frameCount, uint32_t channels)
+    {
+        uint32_t count = frameCount * channels;
+        uint32_t i     = 0;
+        float    value = 0.0f;
+
+#if defined(SAL_DSP_SSE2) || defined(SAL_DSP_NEON)
+        f32x4 peaks = splat(0.0f);
+
+        for (; i + 4 <= count; i += 4)
+        {
+            peaks = max(peaks, abs(load(samples + i)));
+        }
+
+        value = horizontalMax(peaks);
+#endif
+
+        for (; i < count; i++)
+        {
+            value = std::max(value, std::fabs(samples[i]));
+        }
+
+        return value;
+    }
+
+    void gainRamp(float* samples, uint32_t frameCount, uint32_t channels, float gain, float step)
+    {
+        uint32_t frame = 0;
+
+#if defined(SAL_DSP_SSE2) || defined(SAL_DSP_NEON)
+        // one vector covers four mono frames or two stereo frames
+        if (channels == 1 || channels == 2)
+        {
+            uint32_t framesPerVector = 4 / channels;
+
+            f32x4 gains = channels == 1
+                ? set(gain, gain + step, gain + 2.0f * step, gain + 3.0f * step)
+                : set(gain, gain, gain + step, gain + step);
+
+            f32x4 increment = splat(step * (float)framesPerVector);
+
+            for (; frame + framesPerVector <= frameCount; frame += framesPerVector)
+            {
+                float* p = samples + frame * channels;
+
+                store(p, mul(load(p), gains));
+                gains = add(gains, increment);
+            }
+        }
+#endif
+
+        for (; frame < frameCount; frame++)
+        {
+            float frameGain = gain + step * (float)frame;
+
+            for (uint32_t c = 0; c < channels; c++)
+            {
+                samples[frame * channels + c] *= frameGain;
+            }
+        }
+    }
+
+}
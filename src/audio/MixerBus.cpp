@@ -0,0 +1,230 @@
+#include "audio/AudioDevice.h"
+#include "audio/MixerBus.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace sal
+{
+
+    static ma_result InitNode(ma_engine& engine, const ma_node_vtable* vtable, ma_node_base* node, uint32_t& channels, uint32_t& sampleRate)
+    {
+        channels   = ma_engine_get_channels(&engine);
+        sampleRate = ma_engine_get_sample_rate(&engine);
+
+        ma_node_config config  = ma_node_config_init();
+        config.vtable          = vtable;
+        config.pInputChannels  = &channels;
+        config.pOutputChannels = &channels;
+
+        return ma_node_init(ma_engine_get_node_graph(&engine), &config, NULL, node);
+    }
+
+    ma_node_vtable LowPassNode::s_vtable = {
+        LowPassNode::OnProcess,
+        NULL,
+        1, // input buses
+        1, // output buses
+        0,
+    };
+
+    ma_result LowPassNode::Init(ma_engine& engine)
+    {
+        if (ma_engine_get_channels(&engine) > dsp::MAX_CHANNELS)
+        {
+            return MA_INVALID_ARGS;
+        }
+
+        return InitNode(engine, &s_vtable, &m_base, m_channels, m_sampleRate);
+    }
+
+    void LowPassNode::Uninit()
+    {
+        ma_node_uninit(&m_base, NULL);
+    }
+
+    void LowPassNode::OnProcess(ma_node* node, const float** input, ma_uint32* inputFrames, float** output, ma_uint32* outputFrames)
+    {
+        LowPassNode& lowPass = *(LowPassNode*)node;
+
+        uint32_t frames = std::min(*inputFrames, *outputFrames);
+        std::memcpy(output[0], input[0], frames * lowPass.m_channels * sizeof(float));
+
+        float cutoff = lowPass.m_cutoff.load(std::memory_order_relaxed);
+
+        if (cutoff <= 0.0f)
+        {
+            // start from the dry signal when the filter comes back on
+            lowPass.m_state = {};
+            return;
+        }
+
+        float coefficient = dsp::lowPassCoefficient(cutoff, lowPass.m_sampleRate);
+        dsp::lowPass(output[0], frames, lowPass.m_channels, coefficient, lowPass.m_state.data());
+    }
+
+    ma_node_vtable CompressorNode::s_vtable = {
+        CompressorNode::OnProcess,
+        NULL,
+        1,
+        1,
+        0,
+    };
+
+    ma_result CompressorNode::Init(ma_engine& engine)
+    {
+        return InitNode(engine, &s_vtable, &m_base, m_channels, m_sampleRate);
+    }
+
+    void CompressorNode::Uninit()
+    {
+        ma_node_uninit(&m_base, NULL);
+    }
+
+    void CompressorNode::SetParams(const CompressorParams& params)
+    {
+        m_threshold.store(params.threshold, std::memory_order_relaxed);
+        m_ratio.store(std::max(params.ratio, 1.0f), std::memory_order_relaxed);
+        m_attack.store(std::max(params.attack, 0.01f), std::memory_order_relaxed);
+        m_release.store(std::max(params.release, 0.01f), std::memory_order_relaxed);
+        m_makeup.store(params.makeup, std::memory_order_relaxed);
+    }
+
+    void CompressorNode::OnProcess(ma_node* node, const float** input, ma_uint32* inputFrames, float** output, ma_uint32* outputFrames)
+    {
+        CompressorNode& compressor = *(CompressorNode*)node;
+
+        uint32_t channels = compressor.m_channels;
+        uint32_t frames   = std::min(*inputFrames, *outputFrames);
+
+        std::memcpy(output[0], input[0], frames * channels * sizeof(float));
+
+        if (!compressor.m_enabled.load(std::memory_order_relaxed))
+        {
+            compressor.m_envelope = -96.0f;
+            compressor.m_gain     = 1.0f;
+            return;
+        }
+
+        float threshold = compressor.m_threshold.load(std::memory_order_relaxed);
+        float slope     = 1.0f - 1.0f / compressor.m_ratio.load(std::memory_order_relaxed);
+        float makeup    = compressor.m_makeup.load(std::memory_order_relaxed);
+
+        // the envelope moves once per control block, so its coefficients are per block as well
+        float blockSeconds = (float)CONTROL_FRAMES / (float)compressor.m_sampleRate;
+        float attack       = std::exp(-blockSeconds / (compressor.m_attack.load(std::memory_order_relaxed) * 0.001f));
+        float release      = std::exp(-blockSeconds / (compressor.m_release.load(std::memory_order_relaxed) * 0.001f));
+
+        for (uint32_t start = 0; start < frames; start += CONTROL_FRAMES)
+        {
+            uint32_t count   = std::min(CONTROL_FRAMES, frames - start);
+            float*   samples = output[0] + start * channels;
+
+            float level       = 20.0f * std::log10(std::max(dsp::peak(samples, count, channels), 1e-5f));
+            float coefficient = level > compressor.m_envelope ? attack : release;
+
+            compressor.m_envelope = coefficient * compressor.m_envelope + (1.0f - coefficient) * level;
+
+            float over   = std::max(compressor.m_envelope - threshold, 0.0f);
+            float target = std::pow(10.0f, (makeup - over * slope) / 20.0f);
+
+            dsp::gainRamp(samples, count, channels, compressor.m_gain, (target - compressor.m_gain) / (float)count);
+            compressor.m_gain = target;
+        }
+    }
+
+    MixerBus::MixerBus(AudioDevice& device)
+        : m_device(device)
+    {
+    }
+
+    bool MixerBus::Init(MixerBus* parent)
+    {
+        ma_engine& engine = m_device.m_engine;
+
+        m_groupReady      = ma_sound_group_init(&engine, 0, NULL, &m_group) == MA_SUCCESS;
+        m_lowPassReady    = m_groupReady && m_lowPass.Init(engine) == MA_SUCCESS;
+        m_compressorReady = m_lowPassReady && m_compressor.Init(engine) == MA_SUCCESS;
+
+        if (!m_compressorReady)
+        {
+            return false;
+        }
+
+        // group -> low pass -> compressor -> parent
+        ma_node_attach_output_bus((ma_node*)&m_group, 0, m_lowPass.Node(), 0);
+        ma_node_attach_output_bus(m_lowPass.Node(), 0, m_compressor.Node(), 0);
+
+        SetParent(parent);
+
+        return true;
+    }
+
+    void MixerBus::Uninit()
+    {
+        // uninitializing a node detaches everything connected to it
+        if (m_groupReady)
+        {
+            ma_sound_group_uninit(&m_group);
+        }
+
+        if (m_lowPassReady)
+        {
+            m_lowPass.Uninit();
+        }
+
+        if (m_compressorReady)
+        {
+            m_compressor.Uninit();
+        }
+
+        m_groupReady      = false;
+        m_lowPassReady    = false;
+        m_compressorReady = false;
+    }
+
+    void MixerBus::Detach()
+    {
+        if (m_compressorReady)
+        {
+            ma_node_detach_output_bus(m_compressor.Node(), 0);
+        }
+
+        m_parent = nullptr;
+    }
+
+    void MixerBus::SetVolume(float volume)
+    {
+        ma_sound_group_set_volume(&m_group, volume);
+    }
+
+    void MixerBus::SetPan(float pan)
+    {
+        ma_sound_group_set_pan(&m_group, pan);
+    }
+
+    void MixerBus::SetParent(MixerBus* parent)
+    {
+        // a bus can not end up feeding itself
+        for (MixerBus* bus = parent; bus; bus = bus->m_parent)
+        {
+            if (bus == this)
+            {
+                return;
+            }
+        }
+
+        m_parent = parent;
+
+        ma_node* target = parent ? (ma_node*)parent->Group() : ma_engine_get_endpoint(&m_device.m_engine);
+        ma_node_attach_output_bus(m_compressor.Node(), 0, target, 0);
+    }
+
+    void MixerBus::SetCompressor(const CompressorParams& params)
+    {
+        m_compressor.SetParams(params);
+        m_compressor.SetEnabled(true);
+    }
+
+}
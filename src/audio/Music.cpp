@@ -0,0 +1,329 @@
+#include "audio/AudioDevice.h"
+#include "audio/Music.h"
+#include "core/Profiler.h"
+
+#include <cstring>
+
+namespace sal
+{
+
+    ma_data_source_vtable Music::s_vtable = {
+        Music::StreamRead,
+        Music::StreamSeek,
+        Music::StreamGetDataFormat,
+        NULL, // cursor
+        NULL, // length
+        NULL, // looping is handled by the streaming thread
+        0,
+    };
+
+    Music::Music(AudioDevice& device)
+        : m_device(device)
+    {
+    }
+
+    Music::~Music()
+    {
+        // the streaming thread must be done with us before anything goes
+        if (m_streamReady)
+        {
+            m_device.RemoveStream(this);
+        }
+
+        if (m_soundReady)
+        {
+            ma_sound_uninit(&m_sound);
+        }
+
+        if (m_streamReady)
+        {
+            ma_data_source_uninit(&m_stream);
+        }
+
+        if (m_ringReady)
+        {
+            ma_pcm_rb_uninit(&m_ring);
+        }
+
+        if (m_decoderReady)
+        {
+            ma_decoder_uninit(&m_decoder);
+        }
+    }
+
+    void Music::Play()
+    {
+        ma_sound_start(&m_sound);
+    }
+
+    void Music::Stop()
+    {
+        ma_sound_stop(&m_sound);
+    }
+
+    void Music::Seek(uint64_t frame)
+    {
+        m_seek.store(frame, std::memory_order_release);
+        m_device.WakeStreams();
+    }
+
+    void Music::SetVolume(float volume)
+    {
+        ma_sound_set_volume(&m_sound, volume);
+    }
+
+    void Music::SetBus(MixerBus* bus)
+    {
+        ma_node* target = bus ? (ma_node*)bus->Group() : ma_engine_get_endpoint(&m_device.m_engine);
+
+        ma_node_attach_output_bus(&m_sound, 0, target, 0);
+        m_bus = bus;
+    }
+
+    bool Music::Playing() const
+    {
+        return ma_sound_is_playing(&m_sound);
+    }
+
+    Ref<Music> Music::Load(AudioDevice& device, std::string_view filename)
+    {
+        SAL_PROFILE_FUNCTION();
+
+        Ref<Music> music = Ref<Music>(new Music(device));
+
+        // f32 at the file's own rate and channel count, the engine resamples
+        ma_decoder_config config = ma_decoder_config_init(ma_format_f32, 0, 0);
+
+        if (ma_decoder_init_file(std::string(filename).c_str(), &config, &music->m_decoder) != MA_SUCCESS)
+        {
+            std::cout << "Could not open music " << filename << std::endl;
+            return {};
+        }
+
+        music->m_decoderReady = true;
+
+        return music->Init() ? music : Ref<Music>();
+    }
+
+    Ref<Music> Music::Load(AudioDevice& device, const void* data, size_t size)
+    {
+        SAL_PROFILE_FUNCTION();
+
+        Ref<Music> music = Ref<Music>(new Music(device));
+
+        ma_decoder_config config = ma_decoder_config_init(ma_format_f32, 0, 0);
+
+        if (ma_decoder_init_memory(data, size, &config, &music->m_decoder) != MA_SUCCESS)
+        {
+            std::cout << "Could not open music from memory" << std::endl;
+            return {};
+        }
+
+        music->m_decoderReady = true;
+
+        return music->Init() ? music : Ref<Music>();
+    }
+
+    bool Music::Init()
+    {
+        ma_format format = ma_format_unknown;
+
+        if (ma_decoder_get_data_format(&m_decoder, &format, &m_channels, &m_sampleRate, NULL, 0) != MA_SUCCESS)
+        {
+            std::cout << "Could not read music format" << std::endl;
+            return false;
+        }
+
+        if (ma_pcm_rb_init(ma_format_f32, m_channels, RING_FRAMES, NULL, NULL, &m_ring) != MA_SUCCESS)
+        {
+            std::cout << "Could not allocate music ring buffer" << std::endl;
+            return false;
+        }
+
+        m_ringReady = true;
+
+        ma_data_source_config sourceConfig = ma_data_source_config_init();
+        sourceConfig.vtable = &s_vtable;
+
+        if (ma_data_source_init(&sourceConfig, &m_stream) != MA_SUCCESS)
+        {
+            std::cout << "Could not create music data source" << std::endl;
+            return false;
+        }
+
+        m_stream.music = this;
+        m_streamReady  = true;
+
+        // fill the ring before the first callback can ask for it
+        Refill();
+
+        m_device.AddStream(this);
+
+        if (ma_sound_init_from_data_source(&m_device.m_engine, &m_stream, MA_SOUND_FLAG_NO_SPATIALIZATION, NULL, &m_sound) != MA_SUCCESS)
+        {
+            std::cout << "Could not create music sound" << std::endl;
+            return false;
+        }
+
+        m_soundReady = true;
+
+        return true;
+    }
+
+    ma_result Music::Read(float* output, uint64_t frameCount, uint64_t* framesRead)
+    {
+        uint32_t frameSize = m_channels * sizeof(float);
+        uint64_t read      = 0;
+
+        // drop whatever is buffered until the streaming thread has seeked
+        if (m_seek.load(std::memory_order_acquire) != NO_SEEK)
+        {
+            ma_uint32 frames = RING_FRAMES;
+            void*     data   = nullptr;
+
+            while (ma_pcm_rb_acquire_read(&m_ring, &frames, &data) == MA_SUCCESS && frames > 0)
+            {
+                ma_pcm_rb_commit_read(&m_ring, frames);
+                frames = RING_FRAMES;
+            }
+
+            ma_silence_pcm_frames(output, frameCount, ma_format_f32, m_channels);
+
+            *framesRead = frameCount;
+            return MA_SUCCESS;
+        }
+
+        // at most two passes, the second one after the ring wrapped around
+        while (read < frameCount)
+        {
+            ma_uint32 frames = (ma_uint32)std::min<uint64_t>(frameCount - read, RING_FRAMES);
+            void*     data   = nullptr;
+
+            ma_pcm_rb_acquire_read(&m_ring, &frames, &data);
+
+            if (frames == 0)
+            {
+                break;
+            }
+
+            std::memcpy((uint8_t*)output + read * frameSize, data, frames * frameSize);
+            ma_pcm_rb_commit_read(&m_ring, frames);
+
+            read += frames;
+        }
+
+        if (ma_pcm_rb_available_read(&m_ring) < RING_FRAMES / 2)
+        {
+            m_device.WakeStreams();
+        }
+
+        if (read < frameCount)
+        {
+            if (m_finished.load(std::memory_order_acquire))
+            {
+                *framesRead = read;
+                return read == 0 ? MA_AT_END : MA_SUCCESS;
+            }
+
+            // the decoder fell behind, keep the sound alive with silence
+            ma_silence_pcm_frames((uint8_t*)output + read * frameSize, frameCount - read, ma_format_f32, m_channels);
+            m_underruns.fetch_add(1, std::memory_order_relaxed);
+            m_device.m_streamUnderruns.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        *framesRead = frameCount;
+        return MA_SUCCESS;
+    }
+
+    void Music::Refill()
+    {
+        uint64_t seek = m_seek.load(std::memory_order_acquire);
+
+        if (seek != NO_SEEK)
+        {
+            // the audio thread drains the ring while a seek is pending, wait
+            // for it to be empty so no stale frames are played afterwards
+            if (ma_pcm_rb_available_read(&m_ring) > 0)
+            {
+                return;
+            }
+
+            ma_decoder_seek_to_pcm_frame(&m_decoder, seek);
+            m_finished.store(false, std::memory_order_release);
+
+            // only clear the request if no newer one came in meanwhile
+            if (!m_seek.compare_exchange_strong(seek, NO_SEEK, std::memory_order_acq_rel))
+            {
+                return;
+            }
+        }
+
+        bool wrapped = false;
+
+        while (!m_finished.load(std::memory_order_relaxed))
+        {
+            ma_uint32 frames = ma_pcm_rb_available_write(&m_ring);
+            void*     data   = nullptr;
+
+            if (frames == 0)
+            {
+                break;
+            }
+
+            ma_pcm_rb_acquire_write(&m_ring, &frames, &data);
+
+            ma_uint64 decoded = 0;
+            ma_decoder_read_pcm_frames(&m_decoder, data, frames, &decoded);
+            ma_pcm_rb_commit_write(&m_ring, (ma_uint32)decoded);
+
+            // only an empty read right after seeking to 0 means an empty track
+            if (decoded > 0)
+            {
+                wrapped = false;
+            }
+
+            if (decoded < frames)
+            {
+                if (m_looping.load(std::memory_order_relaxed) && !(wrapped && decoded == 0))
+                {
+                    ma_decoder_seek_to_pcm_frame(&m_decoder, 0);
+                    wrapped = true;
+                }
+                else
+                {
+                    m_finished.store(true, std::memory_order_release);
+                }
+            }
+        }
+    }
+
+    ma_result Music::StreamRead(ma_data_source* source, void* output, ma_uint64 frameCount, ma_uint64* framesRead)
+    {
+        Music*   music = ((Stream*)source)->music;
+        uint64_t read  = 0;
+
+        ma_result result = music->Read((float*)output, frameCount, &read);
+        *framesRead = read;
+
+        return result;
+    }
+
+    ma_result Music::StreamSeek(ma_data_source* source, ma_uint64 frame)
+    {
+        // ma_sound seeks back to the start when a finished sound is played again
+        ((Stream*)source)->music->Seek(frame);
+        return MA_SUCCESS;
+    }
+
+    ma_result Music::StreamGetDataFormat(ma_data_source* source, ma_format* format, ma_uint32* channels, ma_uint32* sampleRate, ma_channel* channelMap, size_t channelMapCap)
+    {
+        Music* music = ((Stream*)source)->music;
+
+        *format     = ma_format_f32;
+        *channels   = music->m_channels;
+        *sampleRate = music->m_sampleRate;
+
+        return MA_SUCCESS;
+    }
+
+}
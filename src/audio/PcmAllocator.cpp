@@ -0,0 +1,115 @@
+#include "audio/PcmAllocator.h"
+
+#include <new>
+
+namespace sal
+{
+
+    PcmAllocator::~PcmAllocator()
+    {
+        Trim();
+    }
+
+    void* PcmAllocator::Allocate(size_t size)
+    {
+        size_t sizeClass = SizeClass(size);
+
+        if (sizeClass >= CLASS_COUNT)
+        {
+            return ::operator new(size);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            std::vector<void*>& blocks = m_free[sizeClass];
+
+            if (!blocks.empty())
+            {
+                void* data = blocks.back();
+                blocks.pop_back();
+
+                m_cached -= ClassSize(sizeClass);
+                return data;
+            }
+        }
+
+        return ::operator new(ClassSize(sizeClass));
+    }
+
+    void PcmAllocator::Free(void* data, size_t size)
+    {
+        if (!data)
+        {
+            return;
+        }
+
+        size_t sizeClass = SizeClass(size);
+
+        if (sizeClass >= CLASS_COUNT)
+        {
+            ::operator delete(data);
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (m_cached + ClassSize(sizeClass) > MAX_CACHED_BYTES)
+        {
+            ::operator delete(data);
+            return;
+        }
+
+        m_free[sizeClass].push_back(data);
+        m_cached += ClassSize(sizeClass);
+    }
+
+    void PcmAllocator::Trim()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        for (std::vector<void*>& blocks : m_free)
+        {
+            for (void* data : blocks)
+            {
+                ::operator delete(data);
+            }
+
+            blocks.clear();
+        }
+
+        m_cached = 0;
+    }
+
+    size_t PcmAllocator::CachedBytes() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_cached;
+    }
+
+    size_t PcmAllocator::SizeClass(size_t size)
+    {
+        size_t sizeClass = 0;
+
+        while (sizeClass < CLASS_COUNT && ClassSize(sizeClass) < size)
+        {
+            sizeClass++;
+        }
+
+        return sizeClass;
+    }
+
+    size_t PcmAllocator::ClassSize(size_t sizeClass)
+    {
+        if (sizeClass == 0)
+        {
+            return MIN_CLASS_SIZE;
+        }
+
+        // MIN, then 1.25, 1.5, 1.75 and 2 times each power of two above it
+        size_t base = MIN_CLASS_SIZE << ((sizeClass - 1) / CLASS_STEPS);
+        size_t step = (sizeClass - 1) % CLASS_STEPS + 1;
+
+        return base + step * (base / CLASS_STEPS);
+    }
+
+}
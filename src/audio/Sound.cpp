@@ -1,24 +1,13 @@
+#include "audio/Adpcm.h"
 #include "audio/AudioDevice.h"
 #include "audio/Sound.h"
+#include "core/Profiler.h"
+
+#include <new>
 
 namespace sal
 {
 
-    static ma_format GetMAAudioFormat(EAudioFormat format)
-    {
-        switch (format)
-        {
-            case EAudioFormat::U8: return ma_format_u8;
-            case EAudioFormat::S16: return ma_format_s16;
-            case EAudioFormat::S24: return ma_format_s24;
-            case EAudioFormat::S32: return ma_format_s32;
-            case EAudioFormat::F32: return ma_format_f32;
-        }
-
-        ASSERT(false);
-        return ma_format_unknown;
-    }
-
     static EAudioFormat GetAudioFormat(ma_format format)
     {
         switch (format)
@@ -35,93 +24,188 @@ namespace sal
     }
 
     Sound::Sound(AudioDevice& device, const SoundDesc& desc)
+        : m_device(device), m_desc(desc)
     {
-        ma_result result = {};
+    }
 
-        ma_audio_buffer_config bufferConfig = ma_audio_buffer_config_init(GetMAAudioFormat(desc.format), desc.channels, desc.frameCount, desc.data, NULL);
+    Sound::~Sound()
+    {
+        // voices still reading our pcm have to go first
+        m_device.StopVoices(*this);
+        m_device.GetPcmAllocator().Free(m_desc.data, m_desc.size);
+    }
 
-        result = ma_audio_buffer_init(&bufferConfig, &m_buffer);
+    VoiceHandle Sound::Play(const PlayParams& params)
+    {
+        return m_device.Play(*this, params);
+    }
 
-        if (result != MA_SUCCESS)
+    SoundLoad::Result::~Result()
+    {
+        // decoded but never picked up, the allocator is safe from any thread
+        if (decoded && !taken)
         {
-            //TODO: handle this properly
-            ASSERT(false);
+            device.GetPcmAllocator().Free(desc.data, desc.size);
         }
+    }
 
-        result = ma_sound_init_from_data_source(&device.m_engine, &m_buffer, MA_SOUND_FLAG_DECODE, NULL, &m_sound);
+    SoundLoad::SoundLoad(AudioDevice& device, JobSystem& jobs)
+        : m_jobs(jobs), m_result(MakeRef<Result>(device))
+    {
+    }
 
-        if (result != MA_SUCCESS)
+    Ref<Sound> SoundLoad::Get()
+    {
+        if (m_result->decoded && !m_result->taken)
         {
-            //TODO: handle this properly
-            ASSERT(false);
+            m_sound = MakeRef<Sound>(m_result->device, m_result->desc);
+            m_result->taken = true;
         }
 
-        m_desc = desc;
+        return m_sound;
     }
 
-    Sound::~Sound()
+    void SoundLoad::Wait()
+    {
+        m_jobs.Wait(m_result->counter);
+    }
+
+    Ref<Sound> Sound::Load(AudioDevice& device, std::string_view filename, const SoundLoadOptions& options)
     {
-        ma_sound_uninit(&m_sound);
-        ma_audio_buffer_uninit(&m_buffer);
-        delete[] m_desc.data;
+        SAL_PROFILE_FUNCTION();
+
+        SoundDesc   desc  = {};
+        std::string error = {};
+
+        if (!Decode(device, std::string(filename), options, desc, error))
+        {
+            std::cout << error << std::endl;
+            return {};
+        }
+
+        return MakeRef<Sound>(device, desc);
     }
 
-    void Sound::Play()
+    Ref<SoundLoad> Sound::LoadAsync(AudioDevice& device, JobSystem& jobs, std::string_view filename, const SoundLoadOptions& options)
     {
-        ma_sound_start(&m_sound);
+        Ref<SoundLoad>         load   = MakeRef<SoundLoad>(device, jobs);
+        Ref<SoundLoad::Result>  result = load->m_result;
+
+        // the job only holds the result, so dropping the handle early is
+        // fine. workers destroy jobs after finishing their counter, the
+        // Sound is made by Get on the caller's thread and never reaches
+        // them, voices are not thread safe
+        jobs.Run([result, &device, options, filename = std::string(filename)]() {
+            SAL_PROFILE_SCOPE("Sound::LoadAsync");
+
+            result->decoded = Decode(device, filename, options, result->desc, result->error);
+        }, &result->counter);
+
+        // nobody would pick the job up otherwise
+        if (jobs.WorkerCount() == 0)
+        {
+            jobs.Wait(result->counter);
+        }
+
+        return load;
     }
 
-    Ref<Sound> Sound::Load(AudioDevice& device, std::string_view filename)
+    bool Sound::Decode(AudioDevice& device, const std::string& filename, const SoundLoadOptions& options, SoundDesc& desc, std::string& error)
     {
-        SoundDesc desc = {};
+        PcmAllocator& pcm = device.GetPcmAllocator();
 
-        ma_result result   = {};
+        ma_result  result  = {};
         ma_decoder decoder = {};
-        ma_format format   = ma_format_unknown;
+        ma_format  format  = ma_format_unknown;
+
+        // adpcm is encoded from s16, unknown keeps the file's own format
+        ma_format output = options.storage == SoundStorage::NATIVE ? ma_format_unknown : ma_format_s16;
+
+        // the decoder does the resampling while it decodes, so it is paid once here
+        ma_decoder_config config = ma_decoder_config_init(output, 0, options.resample ? device.SampleRate() : 0);
 
-        result = ma_decoder_init_file(filename.data(), NULL, &decoder);
+        result = ma_decoder_init_file(filename.c_str(), &config, &decoder);
 
         if (result != MA_SUCCESS)
         {
-            //TODO: handle this properly
-            ASSERT(false);
+            error = "Could not open sound " + filename + ": " + ma_result_description(result);
+            return false;
         }
 
         result = ma_decoder_get_data_format(&decoder, &format, &desc.channels, &desc.sampleRate, NULL, 0);
 
-        if (result != MA_SUCCESS)
+        if (result != MA_SUCCESS || format == ma_format_unknown)
+        {
+            error = "Unsupported sample format in " + filename;
+            ma_decoder_uninit(&decoder);
+            return false;
+        }
+
+        if (options.storage == SoundStorage::ADPCM && desc.channels > ADPCM_MAX_CHANNELS)
         {
-            //TODO: handle this properly
-            ASSERT(false);
+            error = "Too many channels for adpcm in " + filename;
+            ma_decoder_uninit(&decoder);
+            return false;
         }
 
         desc.format = GetAudioFormat(format);
-        
+
         ma_uint64 frameCount = 0;
         result = ma_decoder_get_length_in_pcm_frames(&decoder, &frameCount);
-        desc.frameCount = frameCount;
 
-        if (result != MA_SUCCESS)
+        if (result != MA_SUCCESS || frameCount == 0)
         {
-            //TODO: handle this properly
-            ASSERT(false);
+            error = "Could not determine the length of " + filename;
+            ma_decoder_uninit(&decoder);
+            return false;
         }
 
-        desc.data = new float[desc.frameCount * desc.channels];
+        // the buffer matches the decoder output, nothing is widened to float.
+        // adpcm only needs it while encoding, so it stays out of the pool
+        bool   staging = options.storage == SoundStorage::ADPCM;
+        size_t size    = frameCount * ma_get_bytes_per_frame(format, desc.channels);
+        void*  data    = staging ? ::operator new(size) : pcm.Allocate(size);
+
+        auto release = [&]() {
+            if (staging)
+            {
+                ::operator delete(data);
+            }
+            else
+            {
+                pcm.Free(data, size);
+            }
+        };
+
+        ma_uint64 framesRead = 0;
+        result = ma_decoder_read_pcm_frames(&decoder, data, frameCount, &framesRead);
 
-        result = ma_decoder_read_pcm_frames(&decoder, desc.data, desc.frameCount, NULL);
+        ma_decoder_uninit(&decoder);
 
-        if (result != MA_SUCCESS)
+        if (result != MA_SUCCESS && result != MA_AT_END)
         {
-            //TODO: handle this properly
-            ASSERT(false);
+            error = "Could not decode " + filename + ": " + ma_result_description(result);
+            release();
+            return false;
         }
 
-        Ref<Sound> sound = MakeRef<Sound>(device, desc);
+        // lengths from headers can be estimates, only keep what was decoded
+        desc.frameCount = framesRead;
+        desc.data       = data;
+        desc.size       = size;
 
-        ma_decoder_uninit(&decoder);
+        if (options.storage == SoundStorage::ADPCM)
+        {
+            desc.format = EAudioFormat::IMA_ADPCM;
+            desc.size   = AdpcmSize(desc.frameCount, desc.channels);
+            desc.data   = pcm.Allocate(desc.size);
+
+            AdpcmEncode((const int16_t*)data, desc.frameCount, desc.channels, (uint8_t*)desc.data);
+
+            release();
+        }
 
-        return sound;
+        return true;
     }
 
 }
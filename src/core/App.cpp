@@ -2,13 +2,30 @@
 #include "core/App.h"
 #include "core/Window.h"
 #include "core/Input.h"
+#include "core/InputRecorder.h"
+#include "core/Profiler.h"
 #include "graphics/Renderer2D.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
 namespace sal {
 
+    static void PrintSummary(const char* label, std::vector<float>& samples) {
+        if (samples.empty()) {
+            return;
+        }
+
+        SampleSummary summary = Summarize(samples);
+
+        std::printf("%s over %zu frames: avg %.3f ms, min %.3f ms, p50 %.3f ms, p99 %.3f ms, max %.3f ms\n",
+            label, summary.count, summary.average * 1000.0f, summary.min * 1000.0f, summary.p50 * 1000.0f, summary.p99 * 1000.0f, summary.max * 1000.0f);
+    }
+
     App::App(const Settings& settings) {
         ASSERT(!s_instance); s_instance = this;
 
@@ -18,20 +35,25 @@ namespace sal {
         m_renderer = MakeScope<Renderer2D>();
         m_input    = MakeScope<Input>();
         m_audio    = MakeScope<AudioDevice>();
+        m_jobs     = MakeScope<JobSystem>();
     }
 
-    Ref<Texture> App::LoadTexture(const char* filename) {
-        int width  = 0;
-        int height = 0;
-        int comp   = 0;
+    static void PremultiplyAlpha(uint8_t* data, int width, int height) {
+        size_t pixels = (size_t)width * (size_t)height;
 
-        uint8_t* data = stbi_load(filename, &width, &height, &comp, 4);
+        for (size_t i = 0; i < pixels; i++) {
+            uint8_t* pixel = data + i * 4;
+            uint32_t alpha = pixel[3];
 
-        if (!data) {
-            //TODO: error here
-            return {};
+            // rounded x * alpha / 255
+            for (int c = 0; c < 3; c++) {
+                uint32_t value = pixel[c] * alpha + 128;
+                pixel[c] = (uint8_t)((value + (value >> 8)) >> 8);
+            }
         }
+    }
 
+    static Ref<Texture> CreateTexture(uint8_t* data, int width, int height) {
         gpu::TextureDesc texDesc = {
             .filter = gpu::TextureFilter::NEAREST,
             .wrap   = gpu::TextureWrap::CLAMP,
@@ -41,33 +63,206 @@ namespace sal {
             .pixels = data,
         };
 
-        Ref<Texture> texture = MakeRef<Texture>(texDesc);
+        return MakeRef<Texture>(texDesc);
+    }
+
+    Ref<Texture> App::LoadTexture(const char* filename, bool premultiply) {
+        SAL_PROFILE_FUNCTION();
+
+        int width  = 0;
+        int height = 0;
+        int comp   = 0;
+
+        uint8_t* data = stbi_load(filename, &width, &height, &comp, 4);
+
+        if (!data) {
+            //TODO: error here
+            return {};
+        }
+
+        if (premultiply) {
+            PremultiplyAlpha(data, width, height);
+        }
+
+        Ref<Texture> texture = CreateTexture(data, width, height);
         
         stbi_image_free(data);
 
         return texture;
     }
 
+    std::vector<Ref<Texture>> App::LoadTextures(const std::vector<const char*>& filenames, bool premultiply) {
+        SAL_PROFILE_FUNCTION();
+
+        struct Image {
+            uint8_t* data   = nullptr;
+            int      width  = 0;
+            int      height = 0;
+        };
+
+        std::vector<Image> images(filenames.size());
+
+        m_jobs->ParallelFor((uint32_t)filenames.size(), 1, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; i++) {
+                int comp = 0;
+                images[i].data = stbi_load(filenames[i], &images[i].width, &images[i].height, &comp, 4);
+
+                if (images[i].data && premultiply) {
+                    PremultiplyAlpha(images[i].data, images[i].width, images[i].height);
+                }
+            }
+        });
+
+        // the gl context only lives on this thread
+        std::vector<Ref<Texture>> textures(filenames.size());
+
+        for (size_t i = 0; i < images.size(); i++) {
+            if (images[i].data) {
+                textures[i] = CreateTexture(images[i].data, images[i].width, images[i].height);
+                stbi_image_free(images[i].data);
+            }
+        }
+
+        return textures;
+    }
+
     void App::Run() {
-        m_window->Init(m_settings.windowWidth, m_settings.windowHeight, m_settings.windowTitle);
+        SAL_PROFILE_THREAD("main");
+
+        m_jobs->Init(m_settings.jobWorkers);
+        m_window->Init(m_settings);
+        gpu::setProgramCacheDirectory(m_settings.shaderCacheDirectory);
         m_renderer->Init();
-        m_audio->Init();
+
+        // a headless run has no device to play on
+        AudioSettings audio = m_settings.audio;
+        audio.nullBackend |= m_settings.headless;
+        m_audio->Init(audio);
+
+        Scope<InputRecorder> recorder = {};
+        Scope<InputReplay>   replay   = {};
+
+        if (m_settings.replayInput) {
+            replay = InputReplay::Load(m_settings.replayInput);
+
+            if (!replay) {
+                std::exit(-1);
+            }
+
+            m_input->SetReplaying(true);
+        }
+        else if (m_settings.recordInput) {
+            recorder = InputRecorder::Create(m_settings.recordInput);
+
+            if (!recorder) {
+                std::exit(-1);
+            }
+
+            m_input->SetRecorder(recorder.get());
+        }
 
         Init();
 
+        std::vector<float> frameTimes;
+        frameTimes.reserve(m_settings.frameLimit);
+
+        // only frames that saw new input are measured
+        std::vector<float> latencies;
+        double             lastSampleTime = 0.0;
+
+        double accumulator = 0.0;
+
         while (m_window->Running()) {
+            if (m_settings.frameLimit > 0 && frameTimes.size() >= m_settings.frameLimit) {
+                break;
+            }
+
+            SAL_PROFILE_SCOPE("Frame");
+
             float delta = m_window->FrameTime();
 
-            Update(delta);
+            if (replay) {
+                if (replay->Done()) {
+                    break;
+                }
 
-            m_window->SwapBuffers();
+                delta = replay->NextFrame(*m_input, m_window->Time());
+            }
+            else if (recorder) {
+                recorder->EndFrame(delta, m_window->Time());
+            }
+
+            m_frameHistory.Push(delta);
+            m_renderer->BeginFrame();
+            m_audio->NewFrame(delta);
+
+            {
+                SAL_PROFILE_SCOPE("Update");
+                Update(delta);
+            }
+
+            float alpha = 1.0f;
+
+            if (m_settings.fixedTimestep > 0.0f) {
+                SAL_PROFILE_SCOPE("FixedUpdate");
+
+                double step = m_settings.fixedTimestep;
+                accumulator += std::min(delta, m_settings.maxFrameTime);
+
+                for (int i = 0; accumulator >= step; i++) {
+                    // out of budget, drop the backlog rather than catch up
+                    if (i >= m_settings.maxFixedSteps) {
+                        accumulator = std::fmod(accumulator, step);
+                        break;
+                    }
+
+                    FixedUpdate((float)step);
+                    accumulator -= step;
+                }
+
+                alpha = (float)(accumulator / step);
+            }
+
+            m_window->LatchCursor();
+
+            {
+                SAL_PROFILE_SCOPE("Render");
+                Render(alpha);
+            }
+
+            double sampleTime = m_input->SampleTime();
+
+            {
+                SAL_PROFILE_SCOPE("SwapBuffers");
+                m_window->SwapBuffers();
+            }
+
+            if (m_settings.measureInputLatency && sampleTime > lastSampleTime) {
+                latencies.push_back((float)(m_window->PresentTime() - sampleTime));
+                lastSampleTime = sampleTime;
+            }
+
+            if (m_settings.frameLimit > 0) {
+                frameTimes.push_back(m_window->FrameTime());
+            }
         }
 
+        PrintSummary("frame time", frameTimes);
+        PrintSummary("input latency", latencies);
+
         Shutdown();
 
+        m_input->SetRecorder(nullptr);
+        recorder = nullptr;
+
         m_audio->Shutdown();
         m_renderer->Shutdown();
         m_window->Shutdown();
+        m_jobs->Shutdown();
+    }
+
+    void App::Quit() {
+        s_instance->m_window->Close();
     }
 
 }
\ No newline at end of file
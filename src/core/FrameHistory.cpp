@@ -0,0 +1,106 @@
+#include "core/FrameHistory.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace sal {
+
+    size_t PercentileIndex(size_t count, float percentile) {
+        // nearest rank, p99 of 100 samples is the 99th smallest (index 98)
+        size_t rank = (size_t)std::ceil(std::clamp(percentile, 0.0f, 1.0f) * (float)count);
+        return rank > 0 ? rank - 1 : 0;
+    }
+
+    SampleSummary Summarize(std::vector<float>& samples) {
+        SampleSummary summary = {};
+
+        if (samples.empty()) {
+            return summary;
+        }
+
+        std::sort(samples.begin(), samples.end());
+
+        for (float sample : samples) {
+            summary.total += sample;
+        }
+
+        size_t count = samples.size();
+
+        summary.count   = count;
+        summary.average = (float)(summary.total / (double)count);
+        summary.min     = samples.front();
+        summary.p50     = samples[PercentileIndex(count, 0.5f)];
+        summary.p90     = samples[PercentileIndex(count, 0.9f)];
+        summary.p99     = samples[PercentileIndex(count, 0.99f)];
+        summary.max     = samples.back();
+
+        return summary;
+    }
+
+    void FrameHistory::Push(float frameTime) {
+        m_frameTimes[m_head] = frameTime;
+        m_head = (m_head + 1) % CAPACITY;
+
+        if (m_count < CAPACITY) {
+            m_count++;
+        }
+    }
+
+    void FrameHistory::Clear() {
+        m_head  = 0;
+        m_count = 0;
+    }
+
+    float FrameHistory::Latest() const {
+        if (m_count == 0) {
+            return 0.0f;
+        }
+
+        return m_frameTimes[(m_head + CAPACITY - 1) % CAPACITY];
+    }
+
+    float FrameHistory::Min() const {
+        if (m_count == 0) {
+            return 0.0f;
+        }
+
+        return *std::min_element(m_frameTimes.begin(), m_frameTimes.begin() + m_count);
+    }
+
+    float FrameHistory::Max() const {
+        if (m_count == 0) {
+            return 0.0f;
+        }
+
+        return *std::max_element(m_frameTimes.begin(), m_frameTimes.begin() + m_count);
+    }
+
+    float FrameHistory::Average() const {
+        if (m_count == 0) {
+            return 0.0f;
+        }
+
+        float sum = 0.0f;
+
+        for (size_t i = 0; i < m_count; i++) {
+            sum += m_frameTimes[i];
+        }
+
+        return sum / (float)m_count;
+    }
+
+    float FrameHistory::Percentile(float percentile) const {
+        if (m_count == 0) {
+            return 0.0f;
+        }
+
+        std::array<float, CAPACITY> sorted = m_frameTimes;
+
+        size_t nth = PercentileIndex(m_count, percentile);
+
+        std::nth_element(sorted.begin(), sorted.begin() + nth, sorted.begin() + m_count);
+
+        return sorted[nth];
+    }
+
+}
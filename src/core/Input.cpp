@@ -1,10 +1,62 @@
 #include "core/Input.h"
+#include "core/InputRecorder.h"
+
+#include <algorithm>
 
 namespace sal {
 
     void Input::Reset() {
         m_keysPressed.fill(false);
         m_keysReleased.fill(false);
+        m_buttonsPressed.fill(false);
+        m_buttonsReleased.fill(false);
+
+        m_scrollDelta = {};
+
+        // events live for one frame like the pressed and released flags,
+        // so apps that never poll do not fill the queue up
+        m_events.Clear();
+    }
+
+    void Input::PushEvent(const InputEvent& event) {
+        if (m_replaying) {
+            return;
+        }
+
+        if (m_recorder) {
+            m_recorder->Record(event);
+        }
+
+        Apply(event);
+    }
+
+    void Input::ReplayEvent(const InputEvent& event) {
+        Apply(event);
+    }
+
+    void Input::LatchMousePosition(glm::vec2 position, double time) {
+        // an ordinary move as far as the queue and recorder are concerned,
+        // so a replay sees the same positions
+        PushEvent({ .type = InputEventType::MOUSE_MOVE, .position = position, .time = time });
+    }
+
+    void Input::Apply(const InputEvent& event) {
+        m_sampleTime = std::max(m_sampleTime, event.time);
+
+        bool isDown  = event.action != InputAction::RELEASE;
+        bool wasDown = event.action != InputAction::PRESS;
+
+        switch (event.type) {
+            case InputEventType::KEY: SetKey(event.code, isDown, wasDown); break;
+            case InputEventType::MOUSE_BUTTON: SetMouseButton(event.code, isDown, wasDown); break;
+            case InputEventType::MOUSE_MOVE: SetMousePosition(event.position); break;
+            case InputEventType::SCROLL: m_scrollDelta += event.position; break;
+            case InputEventType::CHAR: break;
+        }
+
+        if (!m_events.Push(event)) {
+            m_droppedEvents.fetch_add(1, std::memory_order_relaxed);
+        }
     }
 
     void Input::SetMousePosition(const glm::vec2& position) {
@@ -16,19 +68,20 @@ namespace sal {
             return;
         }
 
-        m_keysDown[key]     = isDown;
-        m_keysPressed[key]  = isDown && !wasDown;
-        m_keysReleased[key] = !isDown && wasDown; 
-    } 
+        // or'd so a press and release between two frames both show up
+        m_keysDown[key]      = isDown;
+        m_keysPressed[key]  |= isDown && !wasDown;
+        m_keysReleased[key] |= !isDown && wasDown;
+    }
 
     void Input::SetMouseButton(int button, bool isDown, bool wasDown) {
         if (button < 0 || button >= BUTTON_BUFFER_SIZE) {
             return;
         }
 
-        m_buttonsDown[button]     = isDown;
-        m_buttonsPressed[button]  = isDown && !wasDown;
-        m_buttonsReleased[button] = !isDown && wasDown; 
+        m_buttonsDown[button]      = isDown;
+        m_buttonsPressed[button]  |= isDown && !wasDown;
+        m_buttonsReleased[button] |= !isDown && wasDown;
     }
 
     bool Input::KeyDown(int key) const {
@@ -0,0 +1,138 @@
+#include "core/InputRecorder.h"
+
+#include <cstring>
+
+namespace sal {
+
+    static constexpr uint32_t MAX_FRAME_EVENTS = 1 << 16;
+
+    InputRecorder::InputRecorder(FILE* file)
+        : m_file(file) {
+    }
+
+    InputRecorder::~InputRecorder() {
+        std::fclose(m_file);
+    }
+
+    void InputRecorder::Record(const InputEvent& event) {
+        m_events.push_back(event);
+    }
+
+    void InputRecorder::EndFrame(float delta, double now) {
+        m_packed.clear();
+
+        for (const InputEvent& event : m_events) {
+            m_packed.push_back({
+                .type   = (uint8_t)event.type,
+                .action = (uint8_t)event.action,
+                .mods   = (uint16_t)event.mods,
+                .code   = event.code,
+                .x      = event.position.x,
+                .y      = event.position.y,
+                .time   = (float)(event.time - now),
+            });
+        }
+
+        uint32_t count = (uint32_t)m_packed.size();
+
+        std::fwrite(&delta, sizeof(delta), 1, m_file);
+        std::fwrite(&count, sizeof(count), 1, m_file);
+
+        if (count > 0) {
+            std::fwrite(m_packed.data(), sizeof(RecordedInputEvent), count, m_file);
+        }
+
+        std::fflush(m_file);
+
+        m_events.clear();
+        m_frames++;
+    }
+
+    Scope<InputRecorder> InputRecorder::Create(std::string_view filename) {
+        FILE* file = std::fopen(std::string(filename).c_str(), "wb");
+
+        if (!file) {
+            std::cout << "Failed to create input recording: " << filename << std::endl;
+            return nullptr;
+        }
+
+        InputRecordingHeader header = {};
+        std::fwrite(&header, sizeof(header), 1, file);
+
+        return Scope<InputRecorder>(new InputRecorder(file));
+    }
+
+    float InputReplay::NextFrame(Input& input, double now) {
+        const Frame& frame = m_frames[m_frame++];
+
+        for (uint32_t i = 0; i < frame.count; i++) {
+            const RecordedInputEvent& recorded = m_events[frame.first + i];
+
+            input.ReplayEvent({
+                .type     = (InputEventType)recorded.type,
+                .action   = (InputAction)recorded.action,
+                .code     = recorded.code,
+                .mods     = recorded.mods,
+                .position = { recorded.x, recorded.y },
+                .time     = now + recorded.time,
+            });
+        }
+
+        return frame.delta;
+    }
+
+    Scope<InputReplay> InputReplay::Load(std::string_view filename) {
+        FILE* file = std::fopen(std::string(filename).c_str(), "rb");
+
+        if (!file) {
+            std::cout << "Failed to open input recording: " << filename << std::endl;
+            return nullptr;
+        }
+
+        InputRecordingHeader expected = {};
+        InputRecordingHeader header   = {};
+
+        bool valid = std::fread(&header, sizeof(header), 1, file) == 1
+            && std::memcmp(header.magic, expected.magic, sizeof(header.magic)) == 0
+            && header.version == expected.version;
+
+        Scope<InputReplay> replay = MakeScope<InputReplay>();
+
+        // a frame cut off at the end of the file is dropped, that is what
+        // a recording interrupted by a crash looks like
+        while (valid) {
+            float    delta = 0.0f;
+            uint32_t count = 0;
+
+            if (std::fread(&delta, sizeof(delta), 1, file) != 1 || std::fread(&count, sizeof(count), 1, file) != 1) {
+                break;
+            }
+
+            // a garbage count would otherwise allocate before the short read fails
+            if (count > MAX_FRAME_EVENTS) {
+                valid = false;
+                break;
+            }
+
+            uint32_t first = (uint32_t)replay->m_events.size();
+            replay->m_events.resize(first + count);
+
+            if (std::fread(replay->m_events.data() + first, sizeof(RecordedInputEvent), count, file) != count) {
+                replay->m_events.resize(first);
+                break;
+            }
+
+            replay->m_frames.push_back({ .delta = delta, .first = first, .count = count });
+        }
+
+        std::fclose(file);
+
+        if (!valid) {
+            std::cout << "Invalid input recording: " << filename << std::endl;
+            return nullptr;
+        }
+
+        return replay;
+    }
+
+}
@@ -0,0 +1,190 @@
+#include "core/JobSystem.h"
+#include "core/Profiler.h"
+
+namespace sal {
+
+    // which system and queue the current thread works for
+    static thread_local JobSystem* t_system = nullptr;
+    static thread_local uint32_t   t_queue  = 0;
+
+    void JobSystem::Init(int workerCount) {
+        if (workerCount < 0) {
+            uint32_t hardwareThreads = std::thread::hardware_concurrency();
+            workerCount = hardwareThreads > 1 ? (int)hardwareThreads - 1 : 0;
+        }
+
+        m_running = true;
+
+        for (int i = 0; i <= workerCount; i++) {
+            m_queues.push_back(MakeScope<Queue>());
+        }
+
+        for (int i = 0; i < workerCount; i++) {
+            m_workers.emplace_back(&JobSystem::WorkerLoop, this, (uint32_t)(i + 1));
+        }
+    }
+
+    void JobSystem::Shutdown() {
+        {
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+            m_running = false;
+        }
+
+        m_wake.notify_all();
+
+        for (std::thread& worker : m_workers) {
+            worker.join();
+        }
+
+        m_workers.clear();
+        m_queues.clear();
+    }
+
+    void JobSystem::Run(Job job, JobCounter* counter) {
+        if (counter) {
+            counter->m_pending.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        Push({ std::move(job), counter });
+    }
+
+    void JobSystem::RunAfter(JobCounter& dependency, Job job, JobCounter* counter) {
+        if (counter) {
+            counter->m_pending.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        {
+            // Finish takes the same lock before running continuations, so
+            // the job is either queued here or picked up there
+            std::lock_guard<std::mutex> lock(dependency.m_mutex);
+
+            if (!dependency.Done()) {
+                dependency.m_continuations.push_back({ std::move(job), counter });
+                return;
+            }
+        }
+
+        Push({ std::move(job), counter });
+    }
+
+    void JobSystem::Wait(JobCounter& counter) {
+        while (!counter.Done()) {
+            if (!TryRunOne()) {
+                std::this_thread::yield();
+            }
+        }
+
+        // the last Finish may still hold the lock, the counter is only
+        // safe to destroy once it let go
+        std::lock_guard<std::mutex> lock(counter.m_mutex);
+    }
+
+    void JobSystem::Push(Task task) {
+        // workers push to their own queue, everyone else shares queue 0
+        uint32_t index = (t_system == this) ? t_queue : 0;
+
+        {
+            Queue& queue = *m_queues[index];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.tasks.push_back(std::move(task));
+        }
+
+        m_queued.fetch_add(1, std::memory_order_release);
+
+        // pairs with the predicate check in WorkerLoop so a worker that is
+        // about to sleep can not miss the notify
+        {
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+        }
+
+        m_wake.notify_one();
+    }
+
+    bool JobSystem::TryRunOne() {
+        if (m_queued.load(std::memory_order_acquire) == 0) {
+            return false;
+        }
+
+        uint32_t own   = (t_system == this) ? t_queue : 0;
+        uint32_t count = (uint32_t)m_queues.size();
+
+        Task task  = {};
+        bool found = false;
+
+        // own queue from the back (most recent, still in cache), then steal
+        // the oldest job from the others
+        for (uint32_t i = 0; i < count && !found; i++) {
+            Queue& queue = *m_queues[(own + i) % count];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+
+            if (queue.tasks.empty()) {
+                continue;
+            }
+
+            if (i == 0) {
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+            }
+            else {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+            }
+
+            found = true;
+        }
+
+        if (!found) {
+            return false;
+        }
+
+        m_queued.fetch_sub(1, std::memory_order_relaxed);
+
+        task.job();
+        Finish(task.counter);
+
+        return true;
+    }
+
+    void JobSystem::Finish(JobCounter* counter) {
+        if (!counter) {
+            return;
+        }
+
+        std::vector<JobCounter::Continuation> continuations;
+
+        {
+            std::lock_guard<std::mutex> lock(counter->m_mutex);
+
+            if (counter->m_pending.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+                return;
+            }
+
+            continuations.swap(counter->m_continuations);
+        }
+
+        for (JobCounter::Continuation& continuation : continuations) {
+            Push({ std::move(continuation.job), continuation.counter });
+        }
+    }
+
+    void JobSystem::WorkerLoop(uint32_t index) {
+        SAL_PROFILE_THREAD("worker");
+
+        t_system = this;
+        t_queue  = index;
+
+        while (true) {
+            if (TryRunOne()) {
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(m_sleepMutex);
+            m_wake.wait(lock, [this]() { return m_queued.load(std::memory_order_acquire) > 0 || !m_running; });
+
+            if (!m_running && m_queued.load(std::memory_order_acquire) == 0) {
+                break;
+            }
+        }
+    }
+
+}
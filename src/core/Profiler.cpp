@@ -0,0 +1,108 @@
+#include "core/Profiler.h"
+
+#include <cstdio>
+#include <mutex>
+
+namespace sal {
+
+    struct ThreadZones {
+        std::array<ProfileZone, Profiler::ZONES_PER_THREAD> zones = {};
+        std::atomic<uint64_t> head = 0;
+
+        uint32_t    threadID = 0;
+        const char* name     = nullptr;
+    };
+
+    // buffers are never freed so zones from finished threads still get exported
+    static std::mutex                      s_threadsMutex;
+    static std::vector<Scope<ThreadZones>> s_threads;
+    static thread_local ThreadZones*       t_zones = nullptr;
+
+    // reference point for converting ticks to microseconds
+    static const uint64_t                              s_startTicks = Profiler::Now();
+    static const std::chrono::steady_clock::time_point s_startTime  = std::chrono::steady_clock::now();
+
+    static ThreadZones* GetThreadZones() {
+        if (!t_zones) {
+            std::lock_guard<std::mutex> lock(s_threadsMutex);
+
+            Scope<ThreadZones> zones = MakeScope<ThreadZones>();
+            zones->threadID = (uint32_t)s_threads.size();
+
+            t_zones = zones.get();
+            s_threads.push_back(std::move(zones));
+        }
+
+        return t_zones;
+    }
+
+    static void WriteEscaped(FILE* file, const char* text) {
+        for (const char* c = text; *c; c++) {
+            if (*c == '"' || *c == '\\') {
+                std::fputc('\\', file);
+            }
+
+            std::fputc(*c, file);
+        }
+    }
+
+    void Profiler::Record(const char* name, uint64_t start, uint64_t end) {
+        ThreadZones* zones = GetThreadZones();
+
+        uint64_t head = zones->head.load(std::memory_order_relaxed);
+        zones->zones[head & (ZONES_PER_THREAD - 1)] = { name, start, end };
+        zones->head.store(head + 1, std::memory_order_release);
+    }
+
+    void Profiler::SetThreadName(const char* name) {
+        GetThreadZones()->name = name;
+    }
+
+    bool Profiler::WriteChromeTrace(const char* filename) {
+        FILE* file = std::fopen(filename, "w");
+
+        if (!file) {
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(s_threadsMutex);
+
+        double   elapsedUs    = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - s_startTime).count();
+        uint64_t elapsedTicks = Now() - s_startTicks;
+        double   usPerTick    = elapsedTicks ? elapsedUs / (double)elapsedTicks : 0.0;
+
+        std::fputs("{\"traceEvents\":[\n", file);
+
+        bool first = true;
+
+        for (const Scope<ThreadZones>& zones : s_threads) {
+            if (zones->name) {
+                std::fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"", first ? "" : ",\n", zones->threadID);
+                WriteEscaped(file, zones->name);
+                std::fputs("\"}}", file);
+
+                first = false;
+            }
+
+            uint64_t head  = zones->head.load(std::memory_order_acquire);
+            uint64_t count = head < ZONES_PER_THREAD ? head : ZONES_PER_THREAD;
+
+            for (uint64_t i = head - count; i < head; i++) {
+                const ProfileZone& zone = zones->zones[i & (ZONES_PER_THREAD - 1)];
+
+                std::fprintf(file, "%s{\"name\":\"", first ? "" : ",\n");
+                WriteEscaped(file, zone.name);
+                std::fprintf(file, "\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                    zones->threadID, (double)(int64_t)(zone.start - s_startTicks) * usPerTick, (double)(zone.end - zone.start) * usPerTick);
+
+                first = false;
+            }
+        }
+
+        std::fputs("\n]}\n", file);
+        std::fclose(file);
+
+        return true;
+    }
+
+}
@@ -0,0 +1,177 @@
+#include "core/SpatialHash.h"
+
+#include "core/Profiler.h"
+
+#include <atomic>
+#include <cmath>
+
+namespace sal {
+    static constexpr uint32_t BUILD_JOB_GRAIN = 4096;
+
+    void SpatialHash::SetCellSize(float size) {
+        ASSERT(size > 0.0f);
+
+        m_cellSize        = size;
+        m_inverseCellSize = 1.0f / size;
+    }
+
+    void SpatialHash::Build(JobSystem& jobs, const AABB* bounds, uint32_t count) {
+        SAL_PROFILE_FUNCTION();
+
+        m_bounds.assign(bounds, bounds + count);
+        m_ranges.resize(count);
+        m_offsets.resize(count + 1);
+        m_offsets[0] = 0;
+
+        jobs.ParallelFor(count, BUILD_JOB_GRAIN, [this](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; i++) {
+                CellRange range = Cells(m_bounds[i]);
+
+                m_ranges[i]      = range;
+                m_offsets[i + 1] = (uint32_t)((range.max.x - range.min.x + 1) * (range.max.y - range.min.y + 1));
+            }
+        });
+
+        for (uint32_t i = 0; i < count; i++) {
+            m_offsets[i + 1] += m_offsets[i];
+        }
+
+        uint32_t total = m_offsets[count];
+
+        // at least as many buckets as entries keeps the chains short
+        uint32_t bucketCount = 1;
+
+        while (bucketCount < total) {
+            bucketCount <<= 1;
+        }
+
+        m_bucketMask = bucketCount - 1;
+        m_buckets.assign(bucketCount + 1, 0);
+        m_entries.resize(total);
+
+        jobs.ParallelFor(count, BUILD_JOB_GRAIN, [this](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; i++) {
+                const CellRange& range = m_ranges[i];
+                Entry* entry = m_entries.data() + m_offsets[i];
+
+                for (int y = range.min.y; y <= range.max.y; y++) {
+                    for (int x = range.min.x; x <= range.max.x; x++) {
+                        *entry++ = { .cell = { x, y }, .object = i };
+
+                        std::atomic_ref<uint32_t>(m_buckets[Bucket({ x, y }) + 1]).fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+            }
+        });
+
+        for (uint32_t i = 0; i < bucketCount; i++) {
+            m_buckets[i + 1] += m_buckets[i];
+        }
+
+        // scatter in object order so bucket contents and query results are
+        // the same from run to run no matter how the jobs were scheduled
+        m_cursors.assign(m_buckets.begin(), m_buckets.end() - 1);
+        m_sorted.resize(total);
+
+        for (const Entry& entry : m_entries) {
+            m_sorted[m_cursors[Bucket(entry.cell)]++] = entry;
+        }
+    }
+
+    void SpatialHash::Clear() {
+        m_bounds.clear();
+        m_ranges.clear();
+        m_offsets.clear();
+        m_entries.clear();
+        m_buckets.clear();
+        m_sorted.clear();
+        m_bucketMask = 0;
+    }
+
+    void SpatialHash::QueryRange(const AABB& range, std::vector<uint32_t>& results) const {
+        if (m_sorted.empty()) {
+            return;
+        }
+
+        CellRange cells = Cells(range);
+
+        for (int y = cells.min.y; y <= cells.max.y; y++) {
+            for (int x = cells.min.x; x <= cells.max.x; x++) {
+                glm::ivec2 cell   = { x, y };
+                uint32_t   bucket = Bucket(cell);
+
+                for (uint32_t i = m_buckets[bucket]; i < m_buckets[bucket + 1]; i++) {
+                    const Entry& entry = m_sorted[i];
+
+                    if (entry.cell != cell || !Overlaps(m_bounds[entry.object], range)) {
+                        continue;
+                    }
+
+                    // objects spanning several cells are only reported from the
+                    // first cell the query shares with them
+                    if (glm::max(m_ranges[entry.object].min, cells.min) == cell) {
+                        results.push_back(entry.object);
+                    }
+                }
+            }
+        }
+    }
+
+    void SpatialHash::QueryPoint(glm::vec2 point, std::vector<uint32_t>& results) const {
+        if (m_sorted.empty()) {
+            return;
+        }
+
+        glm::ivec2 cell   = Cell(point);
+        uint32_t   bucket = Bucket(cell);
+
+        for (uint32_t i = m_buckets[bucket]; i < m_buckets[bucket + 1]; i++) {
+            const Entry& entry = m_sorted[i];
+
+            if (entry.cell == cell && Contains(m_bounds[entry.object], point)) {
+                results.push_back(entry.object);
+            }
+        }
+    }
+
+    void SpatialHash::QueryPairs(std::vector<std::pair<uint32_t, uint32_t>>& pairs) const {
+        SAL_PROFILE_FUNCTION();
+
+        for (uint32_t bucket = 0; bucket + 1 < m_buckets.size(); bucket++) {
+            uint32_t begin = m_buckets[bucket];
+            uint32_t end   = m_buckets[bucket + 1];
+
+            for (uint32_t i = begin; i < end; i++) {
+                const Entry& a = m_sorted[i];
+
+                for (uint32_t j = i + 1; j < end; j++) {
+                    const Entry& b = m_sorted[j];
+
+                    // buckets can be shared by colliding cells
+                    if (a.cell != b.cell || !Overlaps(m_bounds[a.object], m_bounds[b.object])) {
+                        continue;
+                    }
+
+                    // report the pair only from the first cell both touch
+                    if (glm::max(m_ranges[a.object].min, m_ranges[b.object].min) != a.cell) {
+                        continue;
+                    }
+
+                    pairs.emplace_back(std::min(a.object, b.object), std::max(a.object, b.object));
+                }
+            }
+        }
+    }
+
+    glm::ivec2 SpatialHash::Cell(glm::vec2 point) const {
+        return { (int)std::floor(point.x * m_inverseCellSize), (int)std::floor(point.y * m_inverseCellSize) };
+    }
+
+    SpatialHash::CellRange SpatialHash::Cells(const AABB& bounds) const {
+        return { .min = Cell(bounds.min), .max = Cell(bounds.max) };
+    }
+
+    uint32_t SpatialHash::Bucket(glm::ivec2 cell) const {
+        return (((uint32_t)cell.x * 73856093u) ^ ((uint32_t)cell.y * 19349663u)) & m_bucketMask;
+    }
+}
@@ -1,35 +1,62 @@
 #include "core/App.h"
 #include "core/Input.h"
 #include "core/Window.h"
+#include "graphics/gpu.h"
 
+#include <chrono>
 #include <iostream>
+#include <thread>
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
 namespace sal {
 
+    static InputAction GetInputAction(int action) {
+        switch (action) {
+            case GLFW_PRESS: return InputAction::PRESS;
+            case GLFW_RELEASE: return InputAction::RELEASE;
+            case GLFW_REPEAT: return InputAction::REPEAT;
+        }
+
+        return InputAction::PRESS;
+    }
+
     static void MousePosCallback(GLFWwindow* handle, double xpos, double ypos) {
         Window& window = App::GetWindow();
 
         float x = xpos / window.XScale();
         float y = ypos / window.YScale();
 
-        App::GetInput().SetMousePosition({ x, y });
+        App::GetInput().PushEvent({ .type = InputEventType::MOUSE_MOVE, .position = { x, y }, .time = window.Time() });
     }
 
     static void KeyCallback(GLFWwindow* handle, int key, int scancode, int action, int mods) {
-        bool isDown  = (action == GLFW_PRESS) || (action == GLFW_REPEAT);
-        bool wasDown = (action == GLFW_RELEASE) || (action == GLFW_REPEAT);
-        
-        App::GetInput().SetKey(key, isDown, wasDown);
+        App::GetInput().PushEvent({
+            .type   = InputEventType::KEY,
+            .action = GetInputAction(action),
+            .code   = key,
+            .mods   = mods,
+            .time   = App::GetWindow().Time(),
+        });
     }
 
     static void MouseButtonCallback(GLFWwindow* handle, int button, int action, int mods) {
-        bool isDown  = (action == GLFW_PRESS) || (action == GLFW_REPEAT);
-        bool wasDown = (action == GLFW_RELEASE) || (action == GLFW_REPEAT);
+        App::GetInput().PushEvent({
+            .type   = InputEventType::MOUSE_BUTTON,
+            .action = GetInputAction(action),
+            .code   = button,
+            .mods   = mods,
+            .time   = App::GetWindow().Time(),
+        });
+    }
+
+    static void ScrollCallback(GLFWwindow* handle, double xoffset, double yoffset) {
+        App::GetInput().PushEvent({ .type = InputEventType::SCROLL, .position = { (float)xoffset, (float)yoffset }, .time = App::GetWindow().Time() });
+    }
 
-        App::GetInput().SetMouseButton(button, isDown, wasDown);
+    static void CharCallback(GLFWwindow* handle, unsigned int codepoint) {
+        App::GetInput().PushEvent({ .type = InputEventType::CHAR, .code = (int)codepoint, .time = App::GetWindow().Time() });
     }
 
     static void WindowSizeCallback(GLFWwindow* handle, int width, int height) {
@@ -41,7 +68,18 @@ namespace sal {
         glViewport(0, 0, width, height);
     }
 
-    void Window::Init(int width, int height, const char* title) {
+    void Window::Init(const Settings& settings) {
+        int width  = settings.windowWidth;
+        int height = settings.windowHeight;
+
+        m_headless = settings.headless;
+
+        // the null platform needs no display server, with mesa it hands
+        // out a surfaceless EGL context
+        if (m_headless) {
+            glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+        }
+
         if (!glfwInit()) {
             const char* message = NULL;
             glfwGetError(&message);
@@ -52,6 +90,9 @@ namespace sal {
 
         glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
         glfwWindowHint(GLFW_SCALE_TO_MONITOR, GLFW_TRUE);
+        glfwWindowHint(GLFW_VISIBLE, m_headless ? GLFW_FALSE : GLFW_TRUE);
+        // Renderer2D draws opaque sprites out of order against it
+        glfwWindowHint(GLFW_DEPTH_BITS, 24);
 
         glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
         glfwWindowHint(GLFW_CLIENT_API, GLFW_OPENGL_ES_API);
@@ -59,7 +100,7 @@ namespace sal {
         glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 0);
         //glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
-        m_handle = glfwCreateWindow(width, height, title, NULL, NULL);
+        m_handle = glfwCreateWindow(width, height, settings.windowTitle, NULL, NULL);
 
         if (!m_handle) {
             const char* message = NULL;
@@ -74,22 +115,58 @@ namespace sal {
         glfwSetCursorPosCallback(m_handle, MousePosCallback);
         glfwSetKeyCallback(m_handle, KeyCallback);
         glfwSetMouseButtonCallback(m_handle, MouseButtonCallback);
+        glfwSetScrollCallback(m_handle, ScrollCallback);
+        glfwSetCharCallback(m_handle, CharCallback);
         glfwSetWindowSizeCallback(m_handle, WindowSizeCallback);
         glfwSetFramebufferSizeCallback(m_handle, FrameBufferSizeCallback);
 
         glfwMakeContextCurrent(m_handle);
-        glfwSwapInterval(0);
-        glfwShowWindow(m_handle);
+
+        if (!m_headless) {
+            m_vsync = SupportedVSync(settings.vsync);
+            glfwSwapInterval(SwapInterval(m_vsync));
+            glfwShowWindow(m_handle);
+        }
+
+        m_targetFrameTime = settings.targetFps > 0.0f ? 1.0 / settings.targetFps : 0.0;
+        m_waitForEvents   = settings.waitForEvents && !m_headless;
+        m_idleTimeout     = settings.idleTimeout;
+        m_animating       = !m_waitForEvents;
+        m_lateInput       = settings.lateInput;
+        m_finishAfterSwap = settings.measureInputLatency;
 
         if (!gladLoadGLES2Loader((GLADloadproc)glfwGetProcAddress)) {
             std::cout << "GLAD GLES2 loader failed" << std::endl;
             std::exit(-1);
         }
 
+        gpu::init((gpu::LoadProc)glfwGetProcAddress);
+
+        // a surfaceless context has no default framebuffer
+        if (m_headless) {
+            m_framebuffer = gpu::createFramebuffer({ .width = (uint32_t)width, .height = (uint32_t)height });
+
+            if (m_framebuffer.id == 0) {
+                std::cout << "Headless framebuffer creation failed" << std::endl;
+                std::exit(-1);
+            }
+
+            gpu::bind(m_framebuffer);
+            gpu::viewport(0, 0, width, height);
+        }
+
         SetSize(width, height);
+
+        m_timerStart = glfwGetTimerValue();
+        m_lastTime   = Time();
     }
 
     void Window::Shutdown() {
+        if (m_headless) {
+            gpu::bind(gpu::FramebufferHandle{});
+            gpu::destroyFramebuffer(m_framebuffer);
+        }
+
         glfwDestroyWindow(m_handle);
         glfwTerminate();
     }
@@ -98,18 +175,109 @@ namespace sal {
         //TODO: should this be here?
         App::GetInput().Reset();
 
-        glfwSwapBuffers(m_handle);
-        glfwPollEvents();
+        // nothing to present, wait for the gpu so frame times include it
+        if (m_headless) {
+            gpu::finish();
+        }
+        else {
+            glfwSwapBuffers(m_handle);
+
+            // swap only queues the frame, finishing is the closest to it
+            // being shown we can observe
+            if (m_finishAfterSwap) {
+                gpu::finish();
+            }
+        }
+
+        m_presentTime = Time();
+
+        if (m_targetFrameTime > 0.0) {
+            WaitUntil(m_lastTime + m_targetFrameTime);
+        }
+
+        if (m_waitForEvents && !m_animating && !m_frameRequested) {
+            glfwWaitEventsTimeout(m_idleTimeout);
+        }
+        else {
+            glfwPollEvents();
+        }
+
+        m_frameRequested = false;
+
+        double nowTime = Time();
+        m_deltaTime    = (float)(nowTime - m_lastTime);
+        m_lastTime     = nowTime;
+    }
+
+    void Window::LatchCursor() {
+        if (!m_lateInput) {
+            return;
+        }
+
+        double xpos = 0.0;
+        double ypos = 0.0;
+
+        glfwGetCursorPos(m_handle, &xpos, &ypos);
 
-        float nowTime = (float)glfwGetTime();
-        m_deltaTime   = nowTime - m_lastTime;
-        m_lastTime    = nowTime;
+        App::GetInput().LatchMousePosition({ (float)(xpos / m_xscale), (float)(ypos / m_yscale) }, Time());
+    }
+
+    void Window::RequestFrame() {
+        m_frameRequested = true;
+        glfwPostEmptyEvent();
+    }
+
+    double Window::Time() const {
+        return (double)(glfwGetTimerValue() - m_timerStart) / (double)glfwGetTimerFrequency();
+    }
+
+    VSyncMode Window::SupportedVSync(VSyncMode mode) {
+        // the context is created through EGL, which clamps negative swap
+        // intervals to its minimum, so there is no late swap tearing
+        if (mode == VSyncMode::ADAPTIVE) {
+            std::cout << "Adaptive vsync is not available with EGL, using vsync" << std::endl;
+            return VSyncMode::ON;
+        }
+
+        return mode;
+    }
+
+    int Window::SwapInterval(VSyncMode mode) {
+        switch (mode) {
+            case VSyncMode::OFF: return 0;
+            case VSyncMode::ON: return 1;
+            case VSyncMode::ADAPTIVE: return -1;
+        }
+
+        ASSERT(false);
+        return 0;
+    }
+
+    void Window::WaitUntil(double deadline) {
+        // os sleeps overshoot by up to a scheduler tick, sleep until close
+        // to the deadline and spin the rest
+        static constexpr double SPIN_MARGIN = 0.002;
+
+        double remaining = deadline - Time();
+
+        while (remaining > SPIN_MARGIN) {
+            std::this_thread::sleep_for(std::chrono::duration<double>(remaining - SPIN_MARGIN));
+            remaining = deadline - Time();
+        }
+
+        while (Time() < deadline) {
+            std::this_thread::yield();
+        }
     }
 
     bool Window::Running() {
         return !glfwWindowShouldClose(m_handle);
     }
 
+    void Window::Close() {
+        glfwSetWindowShouldClose(m_handle, GLFW_TRUE);
+    }
+
     void Window::SetSize(int width, int height) {
         m_width  = width;
         m_height = height;
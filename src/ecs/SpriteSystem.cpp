@@ -0,0 +1,42 @@
+#include "ecs/SpriteSystem.h"
+
+#include "core/Profiler.h"
+
+namespace sal::ecs {
+    void SpriteSystem::Render(World& world, Renderer2D& renderer) {
+        SAL_PROFILE_FUNCTION();
+
+        m_sprites.clear();
+        m_texture = {};
+
+        world.EachChunk<Transform, SpriteRenderer>([this, &renderer](uint32_t count, const Entity*, Transform* transforms, SpriteRenderer* sprites) {
+            for (uint32_t i = 0; i < count; i++) {
+                if (!(sprites[i].texture == m_texture)) {
+                    Submit(renderer);
+                    m_texture = sprites[i].texture;
+                }
+
+                const Transform& transform = transforms[i];
+
+                m_sprites.push_back({
+                    .position = transform.position,
+                    .size     = transform.size,
+                    .rotation = transform.rotation,
+                    .color    = sprites[i].color,
+                });
+            }
+        });
+
+        Submit(renderer);
+    }
+
+    void SpriteSystem::Submit(Renderer2D& renderer) {
+        if (m_sprites.empty()) {
+            return;
+        }
+
+        // the scratch buffer keeps its capacity so steady state frames do not allocate
+        renderer.DrawSprites(m_texture, m_sprites.data(), (uint32_t)m_sprites.size());
+        m_sprites.clear();
+    }
+}
@@ -0,0 +1,248 @@
+#include "ecs/World.h"
+
+#include <cstring>
+#include <mutex>
+#include <new>
+
+namespace sal::ecs {
+    static constexpr std::align_val_t CHUNK_ALIGNMENT = std::align_val_t(64);
+
+    static std::mutex                 s_componentMutex = {};
+    static std::vector<ComponentInfo> s_components     = {};
+
+    ComponentID RegisterComponent(ComponentInfo info) {
+        std::lock_guard<std::mutex> lock(s_componentMutex);
+
+        if (s_components.size() >= MAX_COMPONENTS) {
+            std::cout << "Too many component types, at most " << MAX_COMPONENTS << " are supported" << std::endl;
+            std::exit(-1);
+        }
+
+        s_components.push_back(info);
+        return (ComponentID)(s_components.size() - 1);
+    }
+
+    const ComponentInfo& GetComponentInfo(ComponentID id) {
+        std::lock_guard<std::mutex> lock(s_componentMutex);
+
+        ASSERT(id < s_components.size());
+        return s_components[id];
+    }
+
+    static uint32_t AlignUp(uint32_t value, uint32_t alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    World::~World() {
+        Clear();
+    }
+
+    Entity World::Create(uint64_t mask) {
+        uint32_t index = 0;
+
+        if (!m_freeList.empty()) {
+            index = m_freeList.back();
+            m_freeList.pop_back();
+        }
+        else {
+            index = (uint32_t)m_records.size();
+            m_records.emplace_back();
+        }
+
+        Entity entity = { .index = index, .generation = m_records[index].generation };
+        Insert(GetArchetype(mask), entity);
+
+        m_count++;
+        return entity;
+    }
+
+    void World::Destroy(Entity entity) {
+        if (!Alive(entity)) {
+            return;
+        }
+
+        Erase(entity);
+
+        Record& record   = m_records[entity.index];
+        record.archetype = nullptr;
+
+        // skip 0 on wrap around so stale entities never match again
+        record.generation++;
+
+        if (record.generation == 0) {
+            record.generation = 1;
+        }
+
+        m_freeList.push_back(entity.index);
+        m_count--;
+    }
+
+    void World::Clear() {
+        for (Scope<Archetype>& archetype : m_archetypes) {
+            for (Archetype::Chunk& chunk : archetype->m_chunks) {
+                ::operator delete(chunk.data, CHUNK_ALIGNMENT);
+            }
+        }
+
+        m_archetypes.clear();
+        m_freeList.clear();
+
+        // keep the generations so entities from before the clear stay invalid
+        for (uint32_t i = 0; i < m_records.size(); i++) {
+            Record& record = m_records[i];
+
+            if (record.archetype) {
+                record.archetype = nullptr;
+                record.generation++;
+
+                if (record.generation == 0) {
+                    record.generation = 1;
+                }
+            }
+
+            m_freeList.push_back(i);
+        }
+
+        m_count = 0;
+    }
+
+    Archetype& World::GetArchetype(uint64_t mask) {
+        for (Scope<Archetype>& archetype : m_archetypes) {
+            if (archetype->m_mask == mask) {
+                return *archetype;
+            }
+        }
+
+        Scope<Archetype> archetype = MakeScope<Archetype>();
+        archetype->m_mask          = mask;
+
+        uint32_t rowSize = sizeof(Entity);
+
+        for (ComponentID id = 0; id < MAX_COMPONENTS; id++) {
+            if (mask & (1ull << id)) {
+                archetype->m_components.push_back(id);
+                archetype->m_sizes[id]  = GetComponentInfo(id).size;
+                rowSize                += archetype->m_sizes[id];
+            }
+        }
+
+        // the entity column comes first, every component column follows aligned
+        // to its type. shrink the row count until the padding fits as well
+        uint32_t capacity = CHUNK_SIZE / rowSize;
+
+        while (capacity > 0) {
+            uint32_t offset = sizeof(Entity) * capacity;
+
+            for (ComponentID id : archetype->m_components) {
+                const ComponentInfo& info = GetComponentInfo(id);
+
+                offset                    = AlignUp(offset, info.alignment);
+                archetype->m_offsets[id]  = offset;
+                offset                   += info.size * capacity;
+            }
+
+            if (offset <= CHUNK_SIZE) {
+                break;
+            }
+
+            capacity--;
+        }
+
+        ASSERT(capacity > 0);
+        archetype->m_capacity = capacity;
+
+        m_archetypes.push_back(std::move(archetype));
+        return *m_archetypes.back();
+    }
+
+    void World::Insert(Archetype& archetype, Entity entity) {
+        if (archetype.m_chunks.empty() || archetype.m_chunks.back().count == archetype.m_capacity) {
+            archetype.m_chunks.push_back({ .data = (uint8_t*)::operator new(CHUNK_SIZE, CHUNK_ALIGNMENT), .count = 0 });
+        }
+
+        // only the last chunk is ever partially filled
+        uint32_t chunk = (uint32_t)archetype.m_chunks.size() - 1;
+        uint32_t row   = archetype.m_chunks[chunk].count++;
+
+        archetype.Entities(chunk)[row] = entity;
+
+        Record& record   = m_records[entity.index];
+        record.archetype = &archetype;
+        record.chunk     = chunk;
+        record.row       = row;
+    }
+
+    void World::Erase(Entity entity) {
+        Record&    record    = m_records[entity.index];
+        Archetype& archetype = *record.archetype;
+
+        uint32_t lastChunk = (uint32_t)archetype.m_chunks.size() - 1;
+        uint32_t lastRow   = archetype.m_chunks[lastChunk].count - 1;
+
+        // fill the hole with the last entity so chunks stay densely packed
+        if (record.chunk != lastChunk || record.row != lastRow) {
+            for (ComponentID id : archetype.m_components) {
+                std::memcpy(archetype.Element(record.chunk, record.row, id), archetype.Element(lastChunk, lastRow, id), archetype.m_sizes[id]);
+            }
+
+            Entity moved                                 = archetype.Entities(lastChunk)[lastRow];
+            archetype.Entities(record.chunk)[record.row] = moved;
+
+            m_records[moved.index].chunk = record.chunk;
+            m_records[moved.index].row   = record.row;
+        }
+
+        if (--archetype.m_chunks[lastChunk].count == 0) {
+            ::operator delete(archetype.m_chunks[lastChunk].data, CHUNK_ALIGNMENT);
+            archetype.m_chunks.pop_back();
+        }
+    }
+
+    void World::Move(Entity entity, uint64_t mask) {
+        Record& record = m_records[entity.index];
+
+        if (record.archetype->m_mask == mask) {
+            return;
+        }
+
+        Archetype& source = *record.archetype;
+        uint32_t   chunk  = record.chunk;
+        uint32_t   row    = record.row;
+
+        Archetype& target = GetArchetype(mask);
+        Insert(target, entity);
+
+        // components only the target has are left for the caller to write
+        for (ComponentID id : source.m_components) {
+            if (!(mask & (1ull << id))) {
+                continue;
+            }
+
+            std::memcpy(target.Element(record.chunk, record.row, id), source.Element(chunk, row, id), source.m_sizes[id]);
+        }
+
+        // Erase works on the record, point it back at the old slot for it
+        Record moved     = record;
+        record.archetype = &source;
+        record.chunk     = chunk;
+        record.row       = row;
+
+        Erase(entity);
+
+        m_records[entity.index] = moved;
+    }
+
+    void* World::GetComponent(Entity entity, ComponentID id) {
+        if (!Alive(entity)) {
+            return nullptr;
+        }
+
+        const Record& record = m_records[entity.index];
+
+        if (!record.archetype || !(record.archetype->m_mask & (1ull << id))) {
+            return nullptr;
+        }
+
+        return record.archetype->Element(record.chunk, record.row, id);
+    }
+}
@@ -0,0 +1,122 @@
+#include "graphics/GpuTimer.h"
+
+#include <cstring>
+
+namespace sal {
+    void GpuTimer::Shutdown() {
+        for (Frame& frame : m_frames) {
+            for (gpu::QueryHandle query : frame.queries) {
+                gpu::destroyQuery(query);
+            }
+
+            frame = {};
+        }
+    }
+
+    void GpuTimer::BeginFrame() {
+        if (m_active) {
+            EndBatch();
+        }
+
+        // a disjoint event invalidates everything currently in flight
+        bool disjoint = gpu::gpuDisjoint();
+
+        // frames are resolved oldest first and stop at the first one that
+        // is not ready so results always move forward
+        for (uint64_t i = m_frameIndex + 1; i <= m_frameIndex + FRAME_LATENCY; i++) {
+            Frame& frame = m_frames[i % FRAME_LATENCY];
+
+            if (!frame.pending) {
+                continue;
+            }
+
+            if (disjoint) {
+                frame.pending = false;
+                continue;
+            }
+
+            if (!Resolve(frame)) {
+                break;
+            }
+        }
+
+        m_frameIndex++;
+
+        Frame& frame = m_frames[m_frameIndex % FRAME_LATENCY];
+
+        // still in flight after FRAME_LATENCY frames, drop it rather than stall
+        frame.pending = false;
+        frame.index   = m_frameIndex;
+        frame.samples.clear();
+    }
+
+    void GpuTimer::BeginBatch(const char* pass, const char* label) {
+        if (!Enabled()) {
+            return;
+        }
+
+        if (m_active) {
+            EndBatch();
+        }
+
+        Frame& frame = m_frames[m_frameIndex % FRAME_LATENCY];
+
+        if (frame.samples.size() == frame.queries.size()) {
+            frame.queries.push_back(gpu::createTimerQuery());
+        }
+
+        gpu::beginTimerQuery(frame.queries[frame.samples.size()]);
+        frame.samples.push_back({ pass, label });
+
+        frame.pending = true;
+        m_active      = true;
+    }
+
+    void GpuTimer::EndBatch() {
+        if (!m_active) {
+            return;
+        }
+
+        gpu::endTimerQuery();
+        m_active = false;
+    }
+
+    bool GpuTimer::Resolve(Frame& frame) {
+        // queries complete in order, if the last one is done they all are
+        if (!gpu::queryResultAvailable(frame.queries[frame.samples.size() - 1])) {
+            return false;
+        }
+
+        m_results.frame        = frame.index;
+        m_results.milliseconds = 0.0;
+        m_results.passes.clear();
+        m_results.batches.clear();
+
+        for (size_t i = 0; i < frame.samples.size(); i++) {
+            const Sample& sample = frame.samples[i];
+            double milliseconds  = (double)gpu::queryResult(frame.queries[i]) / 1000000.0;
+
+            m_results.milliseconds += milliseconds;
+            m_results.batches.push_back({ sample.pass, sample.label, milliseconds });
+
+            GpuTiming* pass = nullptr;
+
+            for (GpuTiming& timing : m_results.passes) {
+                if (std::strcmp(timing.pass, sample.pass) == 0) {
+                    pass = &timing;
+                    break;
+                }
+            }
+
+            if (!pass) {
+                pass = &m_results.passes.emplace_back(GpuTiming{ sample.pass, sample.pass, 0.0 });
+            }
+
+            pass->milliseconds += milliseconds;
+        }
+
+        frame.pending = false;
+
+        return true;
+    }
+}
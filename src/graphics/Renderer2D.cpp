@@ -1,9 +1,14 @@
+#include "core/App.h"
+#include "core/Profiler.h"
 #include "graphics/Renderer2D.h"
 
-#include <glad/glad.h>
+#include <algorithm>
+#include <limits>
 
 namespace sal {
-    static const char* SHARED_VERTEX_SOURCE = "#version 100\n"
+    // quads, circles and lines all share one source, the #defines a batch
+    // needs are picked in Flush. see ShaderVariants
+    static const char* VERTEX_SOURCE = "#version 100\n"
     "\n"
     "attribute vec4 a_position;\n"
     "attribute vec4 a_color;\n"
@@ -11,68 +16,88 @@ namespace sal {
     "attribute vec2 a_localPosition;\n"
     "\n"
     "varying vec4 v_color;\n"
+    "#ifdef TEXTURED\n"
     "varying vec2 v_textureCoord;\n"
+    "#endif\n"
+    "#ifdef CIRCLE\n"
     "varying vec2 v_localPosition;\n"
+    "#endif\n"
     "\n"
     "uniform mat4 u_projection;\n"
     "uniform mat4 u_view;\n"
     "\n"
     "void main() {\n"
     "   v_color         = a_color;\n"
+    "#ifdef TEXTURED\n"
     "   v_textureCoord  = a_textureCoord;\n"
+    "#endif\n"
+    "#ifdef CIRCLE\n"
     "   v_localPosition = a_localPosition;\n"
+    "#endif\n"
     "   gl_Position     = u_projection * u_view * a_position;\n"
     "}";
 
-    static const char* QUAD_FRAGMENT_SOURCE = "#version 100\n"
+    static const char* FRAGMENT_SOURCE = "#version 100\n"
     "\n"
     "precision mediump float;\n"
     "\n"
     "varying vec4 v_color;\n"
+    "#ifdef TEXTURED\n"
     "varying vec2 v_textureCoord;\n"
     "\n"
     "uniform sampler2D u_texture;\n"
-    "\n"
-    "void main() {\n"
-    "   gl_FragColor = v_color * texture2D(u_texture, v_textureCoord);\n"
-    "}";
-
-    static const char* CIRCLE_FRAGMENT_SOURCE = "#version 100\n"
-    "\n"
-    "precision mediump float;\n"
-    "\n"
-    "varying vec4 v_color;\n"
+    "#endif\n"
+    "#ifdef CIRCLE\n"
     "varying vec2 v_localPosition;\n"
+    "#endif\n"
     "\n"
     "void main() {\n"
-    "   float distance = length(v_localPosition);\n"
-    "   float mask     = step(distance, 1.0);\n"
-    "\n"
-    "   if (mask == 0.0) {\n"
-    "       discard;"
+    "#ifdef CIRCLE\n"
+    "   if (length(v_localPosition) > 1.0) {\n"
+    "       discard;\n"
     "   }\n"
+    "#endif\n"
     "\n"
-    "   gl_FragColor = v_color * vec4(vec3(mask), 1.0);\n"
-    "}";
-
-    static const char* LINE_FRAGMENT_SOURCE = "#version 100\n"
-    "\n"
-    "precision mediump float;\n"
+    "   vec4 color = v_color;\n"
     "\n"
-    "varying vec4 v_color;\n"
+    "#ifdef PREMULTIPLIED\n"
+    "   color.rgb *= color.a;\n"
+    "#endif\n"
+    "#ifdef TEXTURED\n"
+    "   color *= texture2D(u_texture, v_textureCoord);\n"
+    "#endif\n"
+    "#ifdef MULTIPLY\n"
+    "   color.rgb = mix(vec3(1.0), color.rgb, color.a);\n"
+    "#endif\n"
     "\n"
-    "void main() {\n"
-    "   gl_FragColor = v_color;\n"
+    "   gl_FragColor = color;\n"
     "}";
 
+    // bit i of a variant mask defines SHADER_FEATURES[i]
+    static constexpr uint32_t SHADER_TEXTURED      = 1 << 0;
+    static constexpr uint32_t SHADER_CIRCLE        = 1 << 1;
+    static constexpr uint32_t SHADER_PREMULTIPLIED = 1 << 2; // vertex colors are straight alpha
+    static constexpr uint32_t SHADER_MULTIPLY      = 1 << 3; // transparent parts multiply by white
+
+    static constexpr std::array<const char*, 4> SHADER_FEATURES = { "TEXTURED", "CIRCLE", "PREMULTIPLIED", "MULTIPLY" };
+
     static constexpr int VERTICES_PER_QUAD = 4;
     static constexpr int INDICES_PER_QUAD  = 6;
     static constexpr int VERTICES_PER_LINE = 2;
 
+    // below this many sprites vertex generation stays on the calling thread
+    static constexpr uint32_t SPRITE_JOB_GRAIN = 2048;
+
     static constexpr int MAX_QUAD_COUNT   = 8192; // 2^13
     static constexpr int MAX_VERTEX_COUNT = MAX_QUAD_COUNT * VERTICES_PER_QUAD;
     static constexpr int MAX_INDEX_COUNT  = MAX_QUAD_COUNT * INDICES_PER_QUAD;
 
+    // depth layers run from z = -1 (back) towards z = 1 (front), the
+    // camera projection maps that range onto the whole depth buffer.
+    // the step stays representable in a 16 bit depth buffer
+    static constexpr float    DEPTH_STEP        = 1.0f / 16384.0f;
+    static constexpr uint32_t MAX_DEPTH_LAYERS  = 32767;
+
     static constexpr glm::vec4 QUAD_VERTEX_POSITIONS[VERTICES_PER_QUAD] = {
         { -0.5f, -0.5f, 0.0f, 1.0f },
         {  0.5f, -0.5f, 0.0f, 1.0f },
@@ -152,6 +177,7 @@ namespace sal {
 
         m_vertexBufferBase = new Vertex[MAX_VERTEX_COUNT];
         m_vertexBufferPtr  = m_vertexBufferBase;
+        m_opaqueUpload     = new Vertex[MAX_VERTEX_COUNT];
 
         // init texture
 
@@ -166,59 +192,80 @@ namespace sal {
             .pixels = whitePixels,
         };
 
-        m_whiteTexture = MakeRef<Texture>(texDesc);
+        m_whiteTexture = m_textures.Register(MakeRef<Texture>(texDesc));
 
         // init shaders
 
-        gpu::ShaderDesc quadShaderDesc = {
-            .vertexSource   = SHARED_VERTEX_SOURCE,
-            .fragmentSource = QUAD_FRAGMENT_SOURCE,
-            .layout         = m_layout,
-        };
+        static_assert(SHADER_FEATURES.size() == SHADER_FEATURE_COUNT, "m_uniformVersion has one entry per feature mask");
 
-        gpu::ShaderDesc circleShaderDesc = {
-            .vertexSource   = SHARED_VERTEX_SOURCE,
-            .fragmentSource = CIRCLE_FRAGMENT_SOURCE,
-            .layout         = m_layout,
-        };
-
-        gpu::ShaderDesc lineShaderDesc = {
-            .vertexSource   = SHARED_VERTEX_SOURCE,
-            .fragmentSource = LINE_FRAGMENT_SOURCE,
-            .layout         = m_layout,
-        };
-
-        m_quadShader   = MakeRef<Shader>(quadShaderDesc);
-        m_circleShader = MakeRef<Shader>(circleShaderDesc);
-        m_lineShader   = MakeRef<Shader>(lineShaderDesc);
+        m_shaders.Init(VERTEX_SOURCE, FRAGMENT_SOURCE, { SHADER_FEATURES.begin(), SHADER_FEATURES.end() }, m_layout);
 
         // cleanup
 
         delete[] indexBuffer;
 
-        //TODO: hack
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        // outside of Begin/End the renderer leaves straight alpha blending on
+        gpu::setBlendMode(gpu::BlendMode::ALPHA);
+        gpu::setDepthTest(gpu::DepthTest::NONE, false);
     }
 
     void Renderer2D::Shutdown()
     {
+        m_gpuTimer.Shutdown();
+
         m_batchVBO.reset();
         m_batchIBO.reset();
 
-        m_whiteTexture.reset();
+        m_textures.Clear();
+        m_whiteTexture = {};
 
-        m_quadShader.reset();
-        m_circleShader.reset();
-        m_lineShader.reset();
+        m_shaders.Clear();
 
         delete[] m_vertexBufferBase;
+        delete[] m_opaqueUpload;
     }
 
-    void Renderer2D::Begin(const Camera& camera) {
+    void Renderer2D::BeginFrame() {
+        m_gpuTimer.BeginFrame();
+
+        m_lastStats = m_stats;
+        m_stats     = {};
+    }
+
+    void Renderer2D::Begin(const Camera& camera, const char* pass) {
         m_camera = camera;
-        m_numDrawCalls = 0;
-            
+        m_pass   = pass;
+
+        m_camera.RecalculateViewMatrix();
+
+        // world space bounds of the view for culling
+        m_inverseViewProjection = glm::inverse(m_camera.ProjectionMatrix() * m_camera.ViewMatrix());
+
+        m_viewMin = glm::vec2( std::numeric_limits<float>::max());
+        m_viewMax = glm::vec2(-std::numeric_limits<float>::max());
+
+        for (const glm::vec4& corner : QUAD_VERTEX_POSITIONS) {
+            glm::vec4 world = m_inverseViewProjection * glm::vec4(corner.x * 2.0f, corner.y * 2.0f, 0.0f, 1.0f);
+            glm::vec2 point = glm::vec2(world) / world.w;
+
+            m_viewMin = glm::min(m_viewMin, point);
+            m_viewMax = glm::max(m_viewMax, point);
+        }
+
+        m_boundShader  = 0;
+        m_boundTexture = 0;
+        m_cameraVersion++;
+
+        // state End left behind, see Init
+        m_boundBlend      = gpu::BlendMode::ALPHA;
+        m_boundDepthTest  = gpu::DepthTest::NONE;
+        m_boundDepthWrite = false;
+
+        m_blendMode    = gpu::BlendMode::ALPHA;
+        m_depthLayer   = 0;
+        m_layerStarted = false;
+        m_depthInUse   = false;
+
         gpu::bind(gpu::BufferType::VERTEX, m_batchVBO->handle());
         gpu::bind(m_layout);
 
@@ -226,51 +273,126 @@ namespace sal {
     }
 
     void Renderer2D::End() {
+        if (!m_cursorSprites.empty()) {
+            App::GetWindow().LatchCursor();
+
+            glm::vec2 cursor = ScreenToWorld(App::GetInput().MousePosition());
+
+            for (const CursorSprite& cursorSprite : m_cursorSprites) {
+                const Sprite& sprite = cursorSprite.sprite;
+                DrawTexture(cursorSprite.texture, cursor + sprite.position, sprite.size, sprite.rotation, sprite.color);
+            }
+
+            m_cursorSprites.clear();
+        }
+
         Flush();
+
+        BindState(gpu::BlendMode::ALPHA, gpu::DepthTest::NONE, false);
     }
 
     void Renderer2D::DrawRect(glm::vec2 position, glm::vec2 size, float rotation, glm::vec4 color) {
         DrawTexture(m_whiteTexture, position, size, rotation, color);
     }
 
-    void Renderer2D::DrawTexture(Ref<Texture> texture, glm::vec2 position, glm::vec2 size, float rotation, glm::vec4 color) {
-        if (RequiresFlushForSpace() || RequiresFlushForMode(BatchMode::Quad) || RequiresFlushForTexture(texture)) {
-            Flush();
-            StartBatch();
+    void Renderer2D::DrawTexture(TextureID texture, glm::vec2 position, glm::vec2 size, float rotation, glm::vec4 color) {
+        // bounding circle so rotation does not matter
+        glm::vec2 extent = glm::vec2(glm::length(size) * 0.5f);
+
+        if (Culled(position - extent, position + extent)) {
+            return;
         }
 
-        glm::mat4 transform(1.0f);
+        bool  opaque = m_blendMode == gpu::BlendMode::NONE;
+        float depth  = NextDepth(opaque);
 
-        transform = glm::translate(transform, glm::vec3(position, 0.0f));
-        transform = glm::rotate(transform, rotation, glm::vec3(0.0f, 0.0f, 1.0f));
-        transform = glm::scale(transform, glm::vec3(size, 1.0f));
+        if (opaque) {
+            WriteQuad(ReserveOpaque(texture, 1), { position, size, rotation, color }, depth);
+            return;
+        }
 
-        for (int i = 0; i < VERTICES_PER_QUAD; i++) {
-            m_vertexBufferPtr->position      = transform * QUAD_VERTEX_POSITIONS[i];
-            m_vertexBufferPtr->color         = color;
-            m_vertexBufferPtr->textureCoord  = QUAD_TEXTURE_COORDS[i];
-            m_vertexBufferPtr->localPosition = {};
+        PrepareBatch(BatchMode::Quad, texture);
 
-            m_vertexBufferPtr++;
-        }
+        WriteQuad(m_vertexBufferPtr, { position, size, rotation, color }, depth);
+        m_vertexBufferPtr += VERTICES_PER_QUAD;
 
         m_batchMode    = BatchMode::Quad;
         m_batchTexture = texture;
+        m_batchBlend   = m_blendMode;
 
         m_vertexCount += VERTICES_PER_QUAD;
         m_indexCount  += INDICES_PER_QUAD;
     }
 
+    void Renderer2D::DrawCursorTexture(TextureID texture, glm::vec2 offset, glm::vec2 size, float rotation, glm::vec4 color) {
+        m_cursorSprites.push_back({ texture, { offset, size, rotation, color } });
+    }
+
+    void Renderer2D::DrawSprites(TextureID texture, const Sprite* sprites, uint32_t count) {
+        if (count == 0) {
+            return;
+        }
+
+        bool  opaque = m_blendMode == gpu::BlendMode::NONE;
+        float depth  = NextDepth(opaque);
+
+        if (opaque) {
+            Vertex* vertices = ReserveOpaque(texture, count);
+
+            App::GetJobs().ParallelFor(count, SPRITE_JOB_GRAIN, [vertices, sprites, depth](uint32_t begin, uint32_t end) {
+                for (uint32_t i = begin; i < end; i++) {
+                    WriteQuad(vertices + i * VERTICES_PER_QUAD, sprites[i], depth);
+                }
+            });
+
+            return;
+        }
+
+        uint32_t submitted = 0;
+
+        while (submitted < count) {
+            PrepareBatch(BatchMode::Quad, texture);
+
+            // fill whatever space is left in the batch in one go
+            uint32_t space  = (MAX_VERTEX_COUNT - m_vertexCount) / VERTICES_PER_QUAD;
+            uint32_t amount = std::min(space, count - submitted);
+
+            Vertex*       vertices = m_vertexBufferPtr;
+            const Sprite* batch    = sprites + submitted;
+
+            App::GetJobs().ParallelFor(amount, SPRITE_JOB_GRAIN, [vertices, batch, depth](uint32_t begin, uint32_t end) {
+                for (uint32_t i = begin; i < end; i++) {
+                    WriteQuad(vertices + i * VERTICES_PER_QUAD, batch[i], depth);
+                }
+            });
+
+            m_vertexBufferPtr += amount * VERTICES_PER_QUAD;
+
+            m_batchMode    = BatchMode::Quad;
+            m_batchTexture = texture;
+            m_batchBlend   = m_blendMode;
+
+            m_vertexCount += amount * VERTICES_PER_QUAD;
+            m_indexCount  += amount * INDICES_PER_QUAD;
+
+            submitted += amount;
+        }
+    }
+
     void Renderer2D::DrawCircle(glm::vec2 position, float radius, glm::vec4 color) {
-        if (RequiresFlushForSpace() || RequiresFlushForMode(BatchMode::Circle)) {
-            Flush();
-            StartBatch();
+        if (Culled(position - glm::vec2(radius), position + glm::vec2(radius))) {
+            return;
         }
 
+        float depth = NextDepth(false);
+
+        PrepareBatch(BatchMode::Circle, {});
+
         glm::mat4 transform = MakeTransform(position, glm::vec2(radius) * 2.0f, 0.0f);
 
         for (int i = 0; i < VERTICES_PER_QUAD; i++) {
             m_vertexBufferPtr->position      = transform * QUAD_VERTEX_POSITIONS[i];
+            m_vertexBufferPtr->position.z    = depth;
             m_vertexBufferPtr->color         = color;
             m_vertexBufferPtr->textureCoord  = {};
             m_vertexBufferPtr->localPosition = QUAD_VERTEX_POSITIONS[i] * 2.0f;
@@ -278,39 +400,61 @@ namespace sal {
             m_vertexBufferPtr++;
         }
 
-        m_batchMode = BatchMode::Circle;
+        m_batchMode  = BatchMode::Circle;
+        m_batchBlend = m_blendMode;
 
         m_vertexCount += VERTICES_PER_QUAD;
         m_indexCount  += INDICES_PER_QUAD;
     }
 
     void Renderer2D::DrawLine(glm::vec2 start, glm::vec2 end, glm::vec4 color) {
-        if (RequiresFlushForSpace() || RequiresFlushForMode(BatchMode::Line)) {
-            Flush();
-            StartBatch();
+        if (Culled(glm::min(start, end), glm::max(start, end))) {
+            return;
         }
 
-        m_vertexBufferPtr->position      = glm::vec4(start, 0.0f, 1.0f);
+        float depth = NextDepth(false);
+
+        PrepareBatch(BatchMode::Line, {});
+
+        m_vertexBufferPtr->position      = glm::vec4(start, depth, 1.0f);
         m_vertexBufferPtr->color         = color;
         m_vertexBufferPtr->textureCoord  = {};
         m_vertexBufferPtr->localPosition = {};
 
         m_vertexBufferPtr++;
 
-        m_vertexBufferPtr->position      = glm::vec4(end, 0.0f, 1.0f);
+        m_vertexBufferPtr->position      = glm::vec4(end, depth, 1.0f);
         m_vertexBufferPtr->color         = color;
         m_vertexBufferPtr->textureCoord  = {};
         m_vertexBufferPtr->localPosition = {};
 
         m_vertexBufferPtr++;
 
-        m_batchMode = BatchMode::Line;
+        m_batchMode  = BatchMode::Line;
+        m_batchBlend = m_blendMode;
+
         m_vertexCount += VERTICES_PER_LINE;
     }
     
+    void Renderer2D::WriteQuad(Vertex* vertices, const Sprite& sprite, float depth) {
+        // same as translate * rotate * scale without building the matrix
+        float c = std::cos(sprite.rotation);
+        float s = std::sin(sprite.rotation);
+
+        for (int i = 0; i < VERTICES_PER_QUAD; i++) {
+            float x = QUAD_VERTEX_POSITIONS[i].x * sprite.size.x;
+            float y = QUAD_VERTEX_POSITIONS[i].y * sprite.size.y;
+
+            vertices[i].position      = { sprite.position.x + c * x - s * y, sprite.position.y + s * x + c * y, depth, 1.0f };
+            vertices[i].color         = sprite.color;
+            vertices[i].textureCoord  = QUAD_TEXTURE_COORDS[i];
+            vertices[i].localPosition = {};
+        }
+    }
+
     void Renderer2D::StartBatch() {
         m_batchMode    = BatchMode::None;
-        m_batchTexture = {}; 
+        m_batchTexture = {};
 
         m_vertexCount = 0;
         m_indexCount  = 0;
@@ -319,11 +463,26 @@ namespace sal {
     }
 
     void Renderer2D::Flush() {
+        // the held back opaque quads have to be in the depth buffer before
+        // anything blended is drawn on top of them
+        FlushOpaque();
+
         if (m_batchMode == BatchMode::None) {
             return;
         }
 
-        m_camera.RecalculateViewMatrix();
+        SAL_PROFILE_FUNCTION();
+
+        BindState(m_batchBlend, m_depthInUse ? gpu::DepthTest::LESS_EQUAL : gpu::DepthTest::NONE, false);
+
+        uint32_t blendFeatures = 0;
+
+        if (m_batchBlend == gpu::BlendMode::PREMULTIPLIED) {
+            blendFeatures = SHADER_PREMULTIPLIED;
+        }
+        else if (m_batchBlend == gpu::BlendMode::MULTIPLY) {
+            blendFeatures = SHADER_MULTIPLY;
+        }
 
         gpu::bind(gpu::BufferType::VERTEX, m_batchVBO->handle());
         gpu::setBufferData(gpu::BufferType::VERTEX, m_batchVBO->handle(), sizeof(Vertex) * m_vertexCount, m_vertexBufferBase);
@@ -332,42 +491,262 @@ namespace sal {
 
         switch (m_batchMode) {
             case BatchMode::Quad: {
-                gpu::bind(m_quadShader->handle());
-                gpu::bind(0, m_batchTexture->handle());
-
-                gpu::setShaderUniform(m_quadShader->handle(), "u_projection", m_camera.ProjectionMatrix());
-                gpu::setShaderUniform(m_quadShader->handle(), "u_view", m_camera.ViewMatrix());
-                gpu::setShaderUniform(m_quadShader->handle(), "u_texture", 0);
-
+                Texture* texture = m_textures.Get(m_batchTexture);
+
+                // plain rects and textures released mid frame skip the
+                // texture fetch, white is what they would sample anyway
+                if (!texture || m_batchTexture == m_whiteTexture) {
+                    BindShader(blendFeatures);
+                }
+                else {
+                    BindShader(SHADER_TEXTURED | blendFeatures);
+                    BindTexture(texture->handle());
+                }
+
+                m_gpuTimer.BeginBatch(m_pass, "quad");
                 gpu::drawPrimitivesIndexed(gpu::PrimitiveType::TRIANGLE_LIST, m_indexCount);
+                m_gpuTimer.EndBatch();
 
                 break;
             }
 
             case BatchMode::Circle: {
-                gpu::bind(m_circleShader->handle());
-
-                gpu::setShaderUniform(m_circleShader->handle(), "u_projection", m_camera.ProjectionMatrix());
-                gpu::setShaderUniform(m_circleShader->handle(), "u_view", m_camera.ViewMatrix());
+                BindShader(SHADER_CIRCLE | blendFeatures);
 
+                m_gpuTimer.BeginBatch(m_pass, "circle");
                 gpu::drawPrimitivesIndexed(gpu::PrimitiveType::TRIANGLE_LIST, m_indexCount);
+                m_gpuTimer.EndBatch();
 
                 break;
             }
 
             case BatchMode::Line: {
-                gpu::bind(m_lineShader->handle());
-
-                gpu::setShaderUniform(m_lineShader->handle(), "u_projection", m_camera.ProjectionMatrix());
-                gpu::setShaderUniform(m_lineShader->handle(), "u_view", m_camera.ViewMatrix());
+                BindShader(blendFeatures);
 
+                m_gpuTimer.BeginBatch(m_pass, "line");
                 gpu::drawPrimitives(gpu::PrimitiveType::LINE_LIST, m_vertexCount);
+                m_gpuTimer.EndBatch();
 
                 break;
             }
         }
 
-        m_numDrawCalls++;
+        m_stats.drawCalls++;
+        m_stats.vertices      += m_vertexCount;
+        m_stats.indices       += m_indexCount;
+        m_stats.bytesUploaded += sizeof(Vertex) * m_vertexCount;
+    }
+
+    void Renderer2D::FlushOpaque() {
+        if (m_opaqueRuns.empty()) {
+            return;
+        }
+
+        SAL_PROFILE_FUNCTION();
+
+        BindState(gpu::BlendMode::NONE, gpu::DepthTest::LESS, true);
+
+        if (!m_depthInUse) {
+            gpu::clearDepth();
+            m_depthInUse = true;
+        }
+
+        gpu::bind(gpu::BufferType::VERTEX, m_batchVBO->handle());
+        gpu::bind(gpu::BufferType::INDEX, m_batchIBO->handle());
+
+        // newest first, everything they cover fails the depth test and
+        // is never shaded. quads of one layer share a depth, so the order
+        // within a run has to be reversed as well
+        for (size_t i = m_opaqueRuns.size(); i-- > 0;) {
+            const OpaqueRun& run     = m_opaqueRuns[i];
+            Texture*         texture = m_textures.Get(run.texture);
+
+            if (!texture || run.texture == m_whiteTexture) {
+                BindShader(0);
+            }
+            else {
+                BindShader(SHADER_TEXTURED);
+                BindTexture(texture->handle());
+            }
+
+            for (uint32_t end = run.first + run.count; end > run.first;) {
+                uint32_t count = std::min(end - run.first, (uint32_t)MAX_QUAD_COUNT);
+                end -= count;
+
+                const Vertex* quads = m_opaqueVertices.data() + (size_t)end * VERTICES_PER_QUAD;
+
+                for (uint32_t quad = 0; quad < count; quad++) {
+                    std::copy_n(quads + (count - 1 - quad) * VERTICES_PER_QUAD, VERTICES_PER_QUAD, m_opaqueUpload + quad * VERTICES_PER_QUAD);
+                }
+
+                uint32_t vertexCount = count * VERTICES_PER_QUAD;
+                uint32_t indexCount  = count * INDICES_PER_QUAD;
+
+                gpu::setBufferData(gpu::BufferType::VERTEX, m_batchVBO->handle(), sizeof(Vertex) * vertexCount, m_opaqueUpload);
+
+                m_gpuTimer.BeginBatch(m_pass, "opaque");
+                gpu::drawPrimitivesIndexed(gpu::PrimitiveType::TRIANGLE_LIST, indexCount);
+                m_gpuTimer.EndBatch();
+
+                m_stats.drawCalls++;
+                m_stats.vertices      += vertexCount;
+                m_stats.indices       += indexCount;
+                m_stats.bytesUploaded += sizeof(Vertex) * vertexCount;
+            }
+        }
+
+        m_opaqueVertices.clear();
+        m_opaqueRuns.clear();
+
+        // later opaque quads must not tie with the ones just drawn
+        m_layerStarted = false;
+    }
+
+    float Renderer2D::NextDepth(bool opaque) {
+        if (m_layerStarted && m_layerOpaque == opaque) {
+            return m_depth;
+        }
+
+        // out of layers, draw everything so far and start over on a
+        // cleared depth buffer
+        if (m_depthLayer == MAX_DEPTH_LAYERS) {
+            Flush();
+            StartBatch();
+
+            m_depthLayer = 0;
+            m_depthInUse = false;
+        }
+
+        m_depthLayer++;
+
+        m_depth        = -1.0f + (float)m_depthLayer * DEPTH_STEP;
+        m_layerOpaque  = opaque;
+        m_layerStarted = true;
+
+        return m_depth;
+    }
+
+    Renderer2D::Vertex* Renderer2D::ReserveOpaque(TextureID texture, uint32_t quads) {
+        uint32_t first = (uint32_t)(m_opaqueVertices.size() / VERTICES_PER_QUAD);
+
+        if (m_opaqueRuns.empty() || m_opaqueRuns.back().texture != texture) {
+            m_opaqueRuns.push_back({ .texture = texture, .first = first, .count = 0 });
+        }
+
+        m_opaqueRuns.back().count += quads;
+        m_opaqueVertices.resize(m_opaqueVertices.size() + quads * VERTICES_PER_QUAD);
+
+        m_stats.opaqueQuads += quads;
+
+        return m_opaqueVertices.data() + (size_t)first * VERTICES_PER_QUAD;
+    }
+
+    void Renderer2D::PrepareBatch(BatchMode mode, TextureID texture) {
+        if (RequiresFlushForSpace()) {
+            m_stats.flushesForSpace++;
+        }
+        else if (RequiresFlushForMode(mode)) {
+            m_stats.flushesForMode++;
+        }
+        else if (RequiresFlushForTexture(texture)) {
+            m_stats.flushesForTexture++;
+        }
+        else if (RequiresFlushForBlend(m_blendMode)) {
+            m_stats.flushesForBlend++;
+        }
+        else {
+            return;
+        }
+
+        Flush();
+        StartBatch();
+    }
+
+    void Renderer2D::BindShader(uint32_t features) {
+        ASSERT(features < SHADER_VARIANT_COUNT);
+
+        gpu::ShaderHandle handle = m_shaders.Get(features)->handle();
+
+        if (m_boundShader == handle.id) {
+            m_stats.stateChangesSkipped++;
+        }
+        else {
+            gpu::bind(handle);
+            m_boundShader = handle.id;
+        }
+
+        if (m_uniformVersion[features] == m_cameraVersion) {
+            m_stats.stateChangesSkipped++;
+            return;
+        }
+
+        gpu::setShaderUniform(handle, "u_projection", m_camera.ProjectionMatrix());
+        gpu::setShaderUniform(handle, "u_view", m_camera.ViewMatrix());
+
+        if (features & SHADER_TEXTURED) {
+            gpu::setShaderUniform(handle, "u_texture", 0);
+        }
+
+        m_uniformVersion[features] = m_cameraVersion;
+    }
+
+    void Renderer2D::BindState(gpu::BlendMode blend, gpu::DepthTest test, bool depthWrite) {
+        if (m_boundBlend == blend) {
+            m_stats.stateChangesSkipped++;
+        }
+        else {
+            gpu::setBlendMode(blend);
+            m_boundBlend = blend;
+        }
+
+        if (m_boundDepthTest == test && m_boundDepthWrite == depthWrite) {
+            m_stats.stateChangesSkipped++;
+            return;
+        }
+
+        gpu::setDepthTest(test, depthWrite);
+
+        m_boundDepthTest  = test;
+        m_boundDepthWrite = depthWrite;
+    }
+
+    void Renderer2D::BindTexture(gpu::TextureHandle texture) {
+        if (m_boundTexture == texture.id) {
+            m_stats.stateChangesSkipped++;
+            return;
+        }
+
+        gpu::bind(0, texture);
+
+        m_boundTexture = texture.id;
+        m_stats.texturesBound++;
+    }
+
+    glm::vec2 Renderer2D::ScreenToWorld(glm::vec2 screen) const {
+        Window& window = App::GetWindow();
+
+        // window y points down, clip space y points up
+        glm::vec2 ndc = {
+            screen.x / (float)window.Width() * 2.0f - 1.0f,
+            1.0f - screen.y / (float)window.Height() * 2.0f,
+        };
+
+        glm::vec4 world = m_inverseViewProjection * glm::vec4(ndc, 0.0f, 1.0f);
+        return glm::vec2(world) / world.w;
+    }
+
+    bool Renderer2D::Culled(glm::vec2 min, glm::vec2 max) {
+        if (!m_culling) {
+            return false;
+        }
+
+        bool outside = max.x < m_viewMin.x || min.x > m_viewMax.x || max.y < m_viewMin.y || min.y > m_viewMax.y;
+
+        if (outside) {
+            m_stats.culledPrimitives++;
+        }
+
+        return outside;
     }
 
     bool Renderer2D::RequiresFlushForSpace() {
@@ -378,7 +757,11 @@ namespace sal {
         return m_batchMode != BatchMode::None && m_batchMode != mode;
     }
 
-    bool Renderer2D::RequiresFlushForTexture(Ref<Texture> texture) {
+    bool Renderer2D::RequiresFlushForTexture(TextureID texture) {
         return m_batchMode != BatchMode::None && m_batchTexture != texture;
     }
-}
+
+    bool Renderer2D::RequiresFlushForBlend(gpu::BlendMode blend) {
+        return m_batchMode != BatchMode::None && m_batchBlend != blend;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,67 @@
+#include "core/Profiler.h"
+#include "graphics/ShaderVariants.h"
+
+#include <cstring>
+
+namespace sal {
+
+    void ShaderVariants::Init(const char* vertexSource, const char* fragmentSource, std::vector<const char*> features, gpu::VertexLayout layout) {
+        ASSERT(features.size() <= MAX_FEATURES);
+
+        m_vertexSource   = vertexSource;
+        m_fragmentSource = fragmentSource;
+        m_features       = std::move(features);
+        m_layout         = layout;
+    }
+
+    void ShaderVariants::Clear() {
+        m_variants.clear();
+    }
+
+    const Ref<Shader>& ShaderVariants::Get(uint32_t mask) {
+        Ref<Shader>& variant = m_variants[mask];
+
+        if (variant) {
+            return variant;
+        }
+
+        SAL_PROFILE_FUNCTION();
+
+        std::string defines = {};
+
+        for (uint32_t i = 0; i < m_features.size(); i++) {
+            if (mask & (1u << i)) {
+                defines += "#define ";
+                defines += m_features[i];
+                defines += "\n";
+            }
+        }
+
+        // both stages see the same defines so varyings can depend on them
+        std::string vertexSource   = AddDefines(m_vertexSource, defines);
+        std::string fragmentSource = AddDefines(m_fragmentSource, defines);
+
+        gpu::ShaderDesc desc = {
+            .vertexSource   = vertexSource.c_str(),
+            .fragmentSource = fragmentSource.c_str(),
+            .layout         = m_layout,
+        };
+
+        variant = MakeRef<Shader>(desc);
+        return variant;
+    }
+
+    std::string ShaderVariants::AddDefines(const char* source, const std::string& defines) {
+        // #version has to stay the first line
+        if (std::strncmp(source, "#version", 8) == 0) {
+            const char* lineEnd = std::strchr(source, '\n');
+
+            if (lineEnd) {
+                return std::string(source, lineEnd + 1) + defines + (lineEnd + 1);
+            }
+        }
+
+        return defines + source;
+    }
+
+}
@@ -0,0 +1,49 @@
+#include "graphics/TextureRegistry.h"
+
+namespace sal {
+    TextureID TextureRegistry::Register(Ref<Texture> texture) {
+        ASSERT(texture);
+
+        uint32_t index = 0;
+
+        if (!m_freeList.empty()) {
+            index = m_freeList.back();
+            m_freeList.pop_back();
+        }
+        else {
+            index = (uint32_t)m_slots.size();
+            m_slots.emplace_back();
+        }
+
+        Slot& slot   = m_slots[index];
+        slot.texture = std::move(texture);
+
+        return { .index = index, .generation = slot.generation };
+    }
+
+    void TextureRegistry::Unregister(TextureID id) {
+        if (!Valid(id)) {
+            return;
+        }
+
+        Slot& slot = m_slots[id.index];
+        slot.texture.reset();
+
+        // skip 0 on wrap around so stale ids never match again
+        slot.generation++;
+
+        if (slot.generation == 0) {
+            slot.generation = 1;
+        }
+
+        m_freeList.push_back(id.index);
+    }
+
+    void TextureRegistry::Clear() {
+        for (uint32_t i = 0; i < m_slots.size(); i++) {
+            if (m_slots[i].texture) {
+                Unregister({ .index = i, .generation = m_slots[i].generation });
+            }
+        }
+    }
+}
@@ -2,7 +2,63 @@
 
 #include "glad/glad.h"
 
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <string>
+
+// GL_EXT_disjoint_timer_query
+#define GL_QUERY_RESULT_EXT           0x8866
+#define GL_QUERY_RESULT_AVAILABLE_EXT 0x8867
+#define GL_TIME_ELAPSED_EXT           0x88BF
+#define GL_GPU_DISJOINT_EXT           0x8FBB
+
+typedef void (APIENTRYP PFNGLGENQUERIESEXTPROC)(GLsizei n, GLuint* ids);
+typedef void (APIENTRYP PFNGLDELETEQUERIESEXTPROC)(GLsizei n, const GLuint* ids);
+typedef void (APIENTRYP PFNGLBEGINQUERYEXTPROC)(GLenum target, GLuint id);
+typedef void (APIENTRYP PFNGLENDQUERYEXTPROC)(GLenum target);
+typedef void (APIENTRYP PFNGLGETQUERYOBJECTUIVEXTPROC)(GLuint id, GLenum pname, GLuint* params);
+typedef void (APIENTRYP PFNGLGETQUERYOBJECTUI64VEXTPROC)(GLuint id, GLenum pname, GLuint64* params);
+
+// GL_OES_get_program_binary
+#define GL_PROGRAM_BINARY_LENGTH_OES      0x8741
+#define GL_NUM_PROGRAM_BINARY_FORMATS_OES 0x87FE
+
+typedef void (APIENTRYP PFNGLGETPROGRAMBINARYOESPROC)(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+typedef void (APIENTRYP PFNGLPROGRAMBINARYOESPROC)(GLuint program, GLenum binaryFormat, const void* binary, GLint length);
+
 namespace sal::gpu {
+    static PFNGLGENQUERIESEXTPROC          glGenQueriesEXT          = nullptr;
+    static PFNGLDELETEQUERIESEXTPROC       glDeleteQueriesEXT       = nullptr;
+    static PFNGLBEGINQUERYEXTPROC          glBeginQueryEXT          = nullptr;
+    static PFNGLENDQUERYEXTPROC            glEndQueryEXT            = nullptr;
+    static PFNGLGETQUERYOBJECTUIVEXTPROC   glGetQueryObjectuivEXT   = nullptr;
+    static PFNGLGETQUERYOBJECTUI64VEXTPROC glGetQueryObjectui64vEXT = nullptr;
+
+    static bool s_timerQueries = false;
+
+    static PFNGLGETPROGRAMBINARYOESPROC glGetProgramBinaryOES = nullptr;
+    static PFNGLPROGRAMBINARYOESPROC    glProgramBinaryOES    = nullptr;
+
+    static bool              s_programBinaries   = false;
+    static std::string       s_programCacheDir   = {};
+    static uint64_t          s_driverHash        = 0;
+    static ProgramCacheStats s_programCacheStats = {};
+
+    // binaries larger than this are treated as a corrupt file
+    static constexpr uint32_t MAX_PROGRAM_BINARY_SIZE = 64 * 1024 * 1024;
+
+    struct ProgramBinaryHeader {
+        char     magic[4] = { 'S', 'A', 'L', 'P' };
+        uint32_t version  = 1;
+        uint64_t key      = 0;
+        uint64_t driver   = 0;
+        uint32_t format   = 0;
+        uint32_t size     = 0;
+    };
+
     static GLenum glVertexFormat(VertexFormat format) {
         switch (format) {
             case VertexFormat::FLOAT:  return GL_FLOAT;
@@ -104,7 +160,18 @@ namespace sal::gpu {
         return 0;
     }
 
-    ShaderHandle createShader(ShaderDesc desc) {
+    // fnv-1a, the terminator is hashed too so "ab" + "c" differs from "a" + "bc"
+    static uint64_t hashString(uint64_t hash, const char* string) {
+        for (const char* c = string; ; c++) {
+            hash = (hash ^ (uint8_t)*c) * 1099511628211ull;
+
+            if (*c == '\0') {
+                return hash;
+            }
+        }
+    }
+
+    static GLuint compileProgram(const ShaderDesc& desc) {
         GLint result = GL_FALSE;
 
         GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
@@ -140,9 +207,220 @@ namespace sal::gpu {
         glDeleteShader(vertexShader);
         glDeleteShader(fragmentShader);
 
+        return program;
+    }
+
+    static GLuint loadProgramBinary(const std::string& path, uint64_t key) {
+        FILE* file = std::fopen(path.c_str(), "rb");
+
+        if (!file) {
+            return 0;
+        }
+
+        ProgramBinaryHeader expected = {};
+        ProgramBinaryHeader header   = {};
+
+        bool valid = std::fread(&header, sizeof(header), 1, file) == 1
+            && std::memcmp(header.magic, expected.magic, sizeof(header.magic)) == 0
+            && header.version == expected.version
+            && header.key == key
+            && header.driver == s_driverHash
+            && header.size > 0 && header.size <= MAX_PROGRAM_BINARY_SIZE;
+
+        std::vector<uint8_t> binary(valid ? header.size : 0);
+        valid = valid && std::fread(binary.data(), 1, binary.size(), file) == binary.size();
+
+        std::fclose(file);
+
+        GLint  result  = GL_FALSE;
+        GLuint program = 0;
+
+        if (valid) {
+            program = glCreateProgram();
+            glProgramBinaryOES(program, (GLenum)header.format, binary.data(), (GLint)binary.size());
+            glGetProgramiv(program, GL_LINK_STATUS, &result);
+        }
+
+        if (result != GL_TRUE) {
+            if (program) {
+                glDeleteProgram(program);
+            }
+
+            // stale or corrupt, the recompiled program replaces it
+            s_programCacheStats.rejected++;
+            std::remove(path.c_str());
+
+            return 0;
+        }
+
+        return program;
+    }
+
+    static void saveProgramBinary(const std::string& path, uint64_t key, GLuint program) {
+        GLint length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH_OES, &length);
+
+        if (length <= 0 || (uint32_t)length > MAX_PROGRAM_BINARY_SIZE) {
+            return;
+        }
+
+        std::vector<uint8_t> binary(length);
+
+        GLsizei written = 0;
+        GLenum  format  = 0;
+
+        glGetProgramBinaryOES(program, length, &written, &format, binary.data());
+
+        if (written <= 0) {
+            return;
+        }
+
+        ProgramBinaryHeader header = {};
+        header.key    = key;
+        header.driver = s_driverHash;
+        header.format = format;
+        header.size   = (uint32_t)written;
+
+        // written next to the final name and renamed, another process
+        // starting at the same time never reads half a file. the temp name
+        // is unique per writer so two processes saving the same key do not
+        // write into one file
+        std::random_device random;
+
+        uint64_t suffix = ((uint64_t)random() << 32 | random()) ^ (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+        char     name[32] = {};
+
+        std::snprintf(name, sizeof(name), ".%016llx.tmp", (unsigned long long)suffix);
+
+        std::string temp = path + name;
+        FILE*       file = std::fopen(temp.c_str(), "wb");
+
+        if (!file) {
+            return;
+        }
+
+        bool saved = std::fwrite(&header, sizeof(header), 1, file) == 1
+            && std::fwrite(binary.data(), 1, header.size, file) == header.size;
+
+        std::fclose(file);
+
+        std::error_code error;
+
+        if (saved) {
+            std::filesystem::rename(temp, path, error);
+        }
+
+        if (!saved || error) {
+            std::remove(temp.c_str());
+        }
+    }
+
+    void init(LoadProc load) {
+        if (hasExtension("GL_EXT_disjoint_timer_query")) {
+            glGenQueriesEXT          = (PFNGLGENQUERIESEXTPROC)load("glGenQueriesEXT");
+            glDeleteQueriesEXT       = (PFNGLDELETEQUERIESEXTPROC)load("glDeleteQueriesEXT");
+            glBeginQueryEXT          = (PFNGLBEGINQUERYEXTPROC)load("glBeginQueryEXT");
+            glEndQueryEXT            = (PFNGLENDQUERYEXTPROC)load("glEndQueryEXT");
+            glGetQueryObjectuivEXT   = (PFNGLGETQUERYOBJECTUIVEXTPROC)load("glGetQueryObjectuivEXT");
+            glGetQueryObjectui64vEXT = (PFNGLGETQUERYOBJECTUI64VEXTPROC)load("glGetQueryObjectui64vEXT");
+
+            s_timerQueries = glGenQueriesEXT && glDeleteQueriesEXT && glBeginQueryEXT && glEndQueryEXT && glGetQueryObjectuivEXT && glGetQueryObjectui64vEXT;
+        }
+
+        if (hasExtension("GL_OES_get_program_binary")) {
+            glGetProgramBinaryOES = (PFNGLGETPROGRAMBINARYOESPROC)load("glGetProgramBinaryOES");
+            glProgramBinaryOES    = (PFNGLPROGRAMBINARYOESPROC)load("glProgramBinaryOES");
+
+            // the extension can be exposed with no formats to save in
+            GLint formats = 0;
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS_OES, &formats);
+
+            s_programBinaries = glGetProgramBinaryOES && glProgramBinaryOES && formats > 0;
+        }
+
+        // binaries are only valid for the exact driver that produced them
+        s_driverHash = 14695981039346656037ull;
+
+        for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION }) {
+            const char* value = (const char*)glGetString(name);
+            s_driverHash      = hashString(s_driverHash, value ? value : "");
+        }
+    }
+
+    bool hasExtension(const char* name) {
+        const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+
+        if (!extensions) {
+            return false;
+        }
+
+        size_t length = std::strlen(name);
+
+        // match whole tokens only, GL_EXT_foo must not match GL_EXT_foo_bar
+        for (const char* c = std::strstr(extensions, name); c; c = std::strstr(c + 1, name)) {
+            bool start = (c == extensions) || (c[-1] == ' ');
+            bool end   = (c[length] == ' ') || (c[length] == '\0');
+
+            if (start && end) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    ShaderHandle createShader(ShaderDesc desc) {
+        std::string path = {};
+        uint64_t    key  = 0;
+
+        if (s_programBinaries && !s_programCacheDir.empty()) {
+            key = hashString(s_driverHash, desc.vertexSource);
+            key = hashString(key, desc.fragmentSource);
+
+            // attribute locations are baked into the binary at link time
+            for (size_t i = 0; i < desc.layout.count; i++) {
+                key = hashString(key, desc.layout.attributes[i].name);
+            }
+
+            char name[32];
+            std::snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+
+            path = s_programCacheDir + "/" + name;
+
+            if (GLuint program = loadProgramBinary(path, key)) {
+                s_programCacheStats.hits++;
+                return { .id = program };
+            }
+
+            s_programCacheStats.misses++;
+        }
+
+        GLuint program = compileProgram(desc);
+
+        if (!path.empty()) {
+            saveProgramBinary(path, key, program);
+        }
+
         return { .id = program };
     }
 
+    void setProgramCacheDirectory(const char* directory) {
+        s_programCacheDir = directory ? directory : "";
+
+        if (!s_programCacheDir.empty()) {
+            std::error_code error;
+            std::filesystem::create_directories(s_programCacheDir, error);
+        }
+    }
+
+    bool programBinariesSupported() {
+        return s_programBinaries;
+    }
+
+    ProgramCacheStats programCacheStats() {
+        return s_programCacheStats;
+    }
+
     void destroyShader(ShaderHandle shader) {
         glDeleteProgram((GLuint)shader.id);
     }
@@ -217,6 +495,52 @@ namespace sal::gpu {
         glBufferSubData(glBufferType(type), 0, size, data);
     }
 
+    FramebufferHandle createFramebuffer(FramebufferDesc desc) {
+        TextureDesc colorDesc = {
+            .filter = TextureFilter::NEAREST,
+            .wrap   = TextureWrap::CLAMP,
+            .format = PixelFormat::RGBA,
+            .width  = desc.width,
+            .height = desc.height,
+            .pixels = nullptr,
+        };
+
+        TextureHandle color = createTexture(colorDesc);
+        GLuint framebuffer  = 0;
+
+        glGenFramebuffers(1, &framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, (GLuint)color.id, 0);
+
+        GLuint depth = 0;
+
+        glGenRenderbuffers(1, &depth);
+        glBindRenderbuffer(GL_RENDERBUFFER, depth);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT16, desc.width, desc.height);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+        GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+        if (status != GL_FRAMEBUFFER_COMPLETE) {
+            glDeleteFramebuffers(1, &framebuffer);
+            glDeleteRenderbuffers(1, &depth);
+            destroyTexture(color);
+
+            return {};
+        }
+
+        return { .id = framebuffer, .color = color, .depth = depth };
+    }
+
+    void destroyFramebuffer(FramebufferHandle framebuffer) {
+        glDeleteFramebuffers(1, (GLuint*)&framebuffer.id);
+        glDeleteRenderbuffers(1, (GLuint*)&framebuffer.depth);
+        destroyTexture(framebuffer.color);
+    }
+
     void bind(ShaderHandle shader) {
         glUseProgram((GLuint)shader.id);
     }
@@ -246,11 +570,121 @@ namespace sal::gpu {
         }
     }
 
+    bool timerQueriesSupported() {
+        return s_timerQueries;
+    }
+
+    QueryHandle createTimerQuery() {
+        GLuint query = 0;
+
+        if (s_timerQueries) {
+            glGenQueriesEXT(1, &query);
+        }
+
+        return { .id = query };
+    }
+
+    void destroyQuery(QueryHandle query) {
+        if (s_timerQueries) {
+            glDeleteQueriesEXT(1, (GLuint*)&query);
+        }
+    }
+
+    void beginTimerQuery(QueryHandle query) {
+        if (s_timerQueries) {
+            glBeginQueryEXT(GL_TIME_ELAPSED_EXT, (GLuint)query.id);
+        }
+    }
+
+    void endTimerQuery() {
+        if (s_timerQueries) {
+            glEndQueryEXT(GL_TIME_ELAPSED_EXT);
+        }
+    }
+
+    bool queryResultAvailable(QueryHandle query) {
+        if (!s_timerQueries) {
+            return false;
+        }
+
+        GLuint available = GL_FALSE;
+        glGetQueryObjectuivEXT((GLuint)query.id, GL_QUERY_RESULT_AVAILABLE_EXT, &available);
+
+        return available == GL_TRUE;
+    }
+
+    uint64_t queryResult(QueryHandle query) {
+        if (!s_timerQueries) {
+            return 0;
+        }
+
+        GLuint64 result = 0;
+        glGetQueryObjectui64vEXT((GLuint)query.id, GL_QUERY_RESULT_EXT, &result);
+
+        return result;
+    }
+
+    bool gpuDisjoint() {
+        if (!s_timerQueries) {
+            return false;
+        }
+
+        GLint disjoint = 0;
+        glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+
+        return disjoint != 0;
+    }
+
+    void bind(FramebufferHandle framebuffer) {
+        glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)framebuffer.id);
+    }
+
     void clear(float r, float g, float b, float a) {
         glClearColor(r, g, b, a);
         glClear(GL_COLOR_BUFFER_BIT);
     }
 
+    void clearDepth() {
+        glDepthMask(GL_TRUE);
+        glClearDepthf(1.0f);
+        glClear(GL_DEPTH_BUFFER_BIT);
+    }
+
+    void setBlendMode(BlendMode mode) {
+        if (mode == BlendMode::NONE) {
+            glDisable(GL_BLEND);
+            return;
+        }
+
+        glEnable(GL_BLEND);
+
+        switch (mode) {
+            case BlendMode::NONE: break;
+            case BlendMode::ALPHA: glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA); break;
+            case BlendMode::PREMULTIPLIED: glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA); break;
+            case BlendMode::ADDITIVE: glBlendFunc(GL_SRC_ALPHA, GL_ONE); break;
+            case BlendMode::MULTIPLY: glBlendFunc(GL_DST_COLOR, GL_ZERO); break;
+        }
+    }
+
+    void setDepthTest(DepthTest test, bool write) {
+        glDepthMask(write ? GL_TRUE : GL_FALSE);
+
+        switch (test) {
+            case DepthTest::NONE: glDisable(GL_DEPTH_TEST); break;
+            case DepthTest::LESS: glEnable(GL_DEPTH_TEST); glDepthFunc(GL_LESS); break;
+            case DepthTest::LESS_EQUAL: glEnable(GL_DEPTH_TEST); glDepthFunc(GL_LEQUAL); break;
+        }
+    }
+
+    void viewport(int x, int y, int width, int height) {
+        glViewport(x, y, width, height);
+    }
+
+    void finish() {
+        glFinish();
+    }
+
     void drawPrimitives(PrimitiveType primitive, uint32_t count) {
         glDrawArrays(glPrimitiveType(primitive), 0, count);
     }